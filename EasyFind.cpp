@@ -26,6 +26,28 @@ const char* LocationTypeToString(LocationType type)
 	}
 }
 
+const char* ZonePathRoutingModeToString(ZonePathRoutingMode mode)
+{
+	switch (mode)
+	{
+	case ZonePathRoutingMode::FewestZones: return "FewestZones";
+	case ZonePathRoutingMode::FastestTravel: return "FastestTravel";
+	case ZonePathRoutingMode::LowestLevel: return "LowestLevel";
+	default: return "Unknown";
+	}
+}
+
+const char* ZonePathRoutingModeDescription(ZonePathRoutingMode mode)
+{
+	switch (mode)
+	{
+	case ZonePathRoutingMode::FewestZones: return "Fewest Zones";
+	case ZonePathRoutingMode::FastestTravel: return "Fastest Travel";
+	case ZonePathRoutingMode::LowestLevel: return "Lowest Level Zones";
+	default: return "Unknown";
+	}
+}
+
 SPAWNINFO* FindSpawnByName(const char* spawnName, bool exact)
 {
 	MQSpawnSearch SearchSpawn;
@@ -76,6 +98,22 @@ void DoGroupCommand(std::string_view command, bool includeSelf)
 	}
 }
 
+std::string EvaluateMacroString(std::string_view expression)
+{
+	// strncpy_s would abort on anything that doesn't fit, and a truncated expression means something else.
+	if (expression.size() >= MAX_STRING)
+	{
+		SPDLOG_ERROR("Macro expression is too long to evaluate ({} characters): {}...", expression.size(), expression.substr(0, 64));
+		return {};
+	}
+
+	char buffer[MAX_STRING] = { 0 };
+	strncpy_s(buffer, expression.data(), expression.size());
+	ParseMacroData(buffer, MAX_STRING);
+
+	return buffer;
+}
+
 //============================================================================
 
 void AddFindableLocationLuaBindings(sol::state_view sv)
@@ -162,12 +200,20 @@ void ShowHelp()
 	WriteChatf(PLUGIN_MSG "\ag/travelto \ao[zonename] \ay@\ax \ao[easyfind command]\ax");
 	WriteChatf(PLUGIN_MSG "    Upon arrival in \ao[zonename]\ax, execute \ao[easyfind command]\ax");
 	WriteChatf(PLUGIN_MSG "    Ex: /travelto poknowledge @ Dogle Pitt");
+	WriteChatf(PLUGIN_MSG "\ag/travelto \aynearest\ax \ao[zone or zone group] [zone or zone group]...\ax [\ay@\ax \ao[easyfind command]\ax]");
+	WriteChatf(PLUGIN_MSG "    Travel to whichever of the zones is closest. Zone groups are defined under ZoneGroups in ZoneConnections.yaml");
+	WriteChatf(PLUGIN_MSG "    Ex: /travelto nearest hubs");
 	WriteChatf(PLUGIN_MSG "\ag/travelto \aygroup\ax \ao[command]");
 	WriteChatf("    Broadcasts the command to the group, using the configured group plugin.");
 	WriteChatf(PLUGIN_MSG "\ag/travelto \ayactivate\aw - If an existing zone path is active (created by the zone guide), "
 		"activate that path with /travelto");
 	WriteChatf(PLUGIN_MSG "\ag/travelto \aystop\aw - Stops an active /travelto");
 	WriteChatf(PLUGIN_MSG "\ag/travelto \aydump\aw - Dumps zone information from the zone guide to resources/ZoneGuide.yaml");
+	WriteChatf(PLUGIN_MSG "\ag/travelto \aybenchmark\aw - Measures zone path generation performance");
+	WriteChatf(PLUGIN_MSG "\ag/travelto \aybenchmark suite\ax \ao[dump] [all] [save] [threshold %]\aw - Measures per query latency "
+		"against the saved baseline. \aydump\aw uses resources/ZoneGuide.yaml instead of the live zone guide, \ayall\aw runs "
+		"every zone pair and \aysave\aw saves the results as the new baseline");
+	WriteChatf(PLUGIN_MSG "\ag/travelto \aycast\ax \ao[character] [spell]\aw - Asks a group member to cast a teleport spell for /travelto");
 }
 
 void Command_EasyFind(SPAWNINFO* pSpawn, char* szLine)
@@ -266,6 +312,19 @@ void Command_TravelTo(SPAWNINFO* pSpawn, char* szLine)
 		return;
 	}
 
+	if (ci_equals(szLine, "benchmark"))
+	{
+		ZonePath_Benchmark();
+		return;
+	}
+
+	if (ci_starts_with(szLine, "benchmark suite"))
+	{
+		szLine += strlen("benchmark suite");
+		ZonePath_BenchmarkSuite(szLine);
+		return;
+	}
+
 	if (ci_starts_with(szLine, "group "))
 	{
 		szLine += strlen("group") + 1;
@@ -275,6 +334,17 @@ void Command_TravelTo(SPAWNINFO* pSpawn, char* szLine)
 		return;
 	}
 
+	// Sent by the group member that picked us to cast a teleport spell for their route.
+	if (ci_starts_with(szLine, "cast "))
+	{
+		std::string_view args = std::string_view(szLine).substr(strlen("cast") + 1);
+		size_t pos = args.find(' ');
+
+		if (pLocalPC && pos != std::string_view::npos && ci_equals(args.substr(0, pos), pLocalPC->Name))
+			ZonePath_CastRequestedTeleportSpell(args.substr(pos + 1));
+		return;
+	}
+
 	if (!pLocalPC)
 	{
 		SPDLOG_ERROR("You need to be in game to travel!");
@@ -306,6 +376,51 @@ void Command_TravelTo(SPAWNINFO* pSpawn, char* szLine)
 	if (command.length() > 2 && command[0] == '"' && command[command.length() - 1] == '"')
 		command = command.substr(1, command.length() - 2);
 
+	std::string_view nearestArgs = command;
+	if (ci_starts_with(nearestArgs, "nearest "))
+	{
+		nearestArgs.remove_prefix(strlen("nearest") + 1);
+
+		// Collect the candidate zones, expanding any zone groups.
+		std::vector<EQZoneIndex> targetZones;
+
+		for (std::string_view name : split_view(nearestArgs, ' ', true))
+		{
+			if (const std::vector<EQZoneIndex>* zoneGroup = g_zoneConnections->GetZoneGroup(name))
+			{
+				targetZones.insert(targetZones.end(), zoneGroup->begin(), zoneGroup->end());
+			}
+			else if (EQZoneInfo* pZone = pWorldData->GetZone(GetZoneID(std::string(name).c_str())))
+			{
+				targetZones.push_back(pZone->Id);
+			}
+			else
+			{
+				SPDLOG_ERROR("Invalid zone or zone group: {}", name);
+				return;
+			}
+		}
+
+		ZonePath_GenerateNearestPathAsync(pCurrentZone->Id, targetZones,
+			[fromName = std::string(pCurrentZone->LongName), query = std::move(query)](ZonePathRequest& request, const std::string& message)
+			{
+				if (request.zonePath.empty())
+				{
+					SPDLOG_ERROR("Failed to generate path from \ay{}\ar: {}", fromName, message);
+					return;
+				}
+
+				if (query.empty())
+					SPDLOG_INFO("\aoTraveling to nearest zone: \ag{}", GetFullZone(request.zonePath.back().zoneId));
+				else
+					SPDLOG_INFO("\aoTraveling to nearest zone: \ag{}\ao at \ay{}", GetFullZone(request.zonePath.back().zoneId), query);
+
+				request.targetQuery = query;
+				ZonePath_SetActive(request, true);
+			}, true);
+		return;
+	}
+
 	EQZoneInfo* pTargetZone = pWorldData->GetZone(GetZoneID(command.c_str()));
 	if (!pTargetZone)
 	{
@@ -319,25 +434,25 @@ void Command_TravelTo(SPAWNINFO* pSpawn, char* szLine)
 		return;
 	}
 
-	std::string message;
-	auto path = ZonePath_GeneratePath(pCurrentZone->Id, pTargetZone->Id, message);
-	if (path.empty())
-	{
-		SPDLOG_ERROR("Failed to generate path from \ay{}\ar to \ay{}\ar: {}",
-			pCurrentZone->LongName, pTargetZone->LongName, message);
-		return;
-	}
-
-	if (query.empty())
-		SPDLOG_INFO("\aoTraveling to: \ag{}", pTargetZone->LongName);
-	else
-		SPDLOG_INFO("\aoTraveling to: \ag{}\ao at \ay{}", pTargetZone->LongName, query);
-
-	ZonePathRequest request;
-	request.zonePath = std::move(path);
-	request.targetQuery = std::move(query);
-
-	ZonePath_SetActive(request, true);
+	// The route is found off the game thread, and we start traveling once it comes back.
+	ZonePath_GeneratePathAsync(pCurrentZone->Id, pTargetZone->Id, MaxZonePathAlternatives,
+		[fromName = std::string(pCurrentZone->LongName), toName = std::string(pTargetZone->LongName),
+			query = std::move(query)](ZonePathRequest& request, const std::string& message)
+		{
+			if (request.zonePath.empty())
+			{
+				SPDLOG_ERROR("Failed to generate path from \ay{}\ar to \ay{}\ar: {}", fromName, toName, message);
+				return;
+			}
+
+			if (query.empty())
+				SPDLOG_INFO("\aoTraveling to: \ag{}", toName);
+			else
+				SPDLOG_INFO("\aoTraveling to: \ag{}\ao at \ay{}", toName, query);
+
+			request.targetQuery = query;
+			ZonePath_SetActive(request, true);
+		}, true);
 }
 
 class EasyFindType : public MQ2Type
@@ -403,8 +518,6 @@ PLUGIN_API void InitializePlugin()
 
 	AddCommand("/easyfind", Command_EasyFind, false, true, true);
 	AddCommand("/travelto", Command_TravelTo, false, true, true);
-
-	g_zoneConnections->LoadFindableLocations();
 }
 
 PLUGIN_API void ShutdownPlugin()
@@ -416,6 +529,7 @@ PLUGIN_API void ShutdownPlugin()
 	Lua_Shutdown();
 	FindWindow_Shutdown();
 	ImGui_Shutdown();
+	ZonePath_Shutdown();
 
 	delete g_configuration;
 	delete g_zoneConnections;
@@ -16,7 +16,19 @@ enum class LocationType {
 };
 const char* LocationTypeToString(LocationType type);
 
+// How /travelto chooses between routes
+enum class ZonePathRoutingMode {
+	FewestZones,                              // fewest zone transfers
+	FastestTravel,                            // lowest estimated travel time
+	LowestLevel,                              // lowest highest zone level, then fewest zone transfers
+
+	Max,
+};
+const char* ZonePathRoutingModeToString(ZonePathRoutingMode mode);
+const char* ZonePathRoutingModeDescription(ZonePathRoutingMode mode);
+
 struct ParsedFindableLocation;
+struct ParsedTeleport;
 
 // loaded configuration information
 struct FindableLocation
@@ -70,6 +82,7 @@ SPAWNINFO* FindSpawnByName(const char* spawnName, bool exact);
 void ExecuteLuaScript(std::string_view luaScript, const std::shared_ptr<FindableLocation>& findableLocation);
 
 void DoGroupCommand(std::string_view command, bool includeSelf);
+std::string EvaluateMacroString(std::string_view expression);
 
 // Find Window Handlers
 void FindWindow_Initialize();
@@ -100,31 +113,66 @@ bool Navigation_ExecuteCommand(std::string_view navCommand);
 void Navigation_Stop();
 
 // ZonePath Handlers
+// Paths outlive the zone connections they were generated from, so they only hold on to what
+// identifies a connection, and look it up again when it is used.
 struct ZonePathNode {
 	EQZoneIndex zoneId;
 	int transferTypeIndex;
-	const ParsedFindableLocation* location = nullptr;
-	const ZoneGuideConnection* connection = nullptr;
-
-	ZonePathNode(EQZoneIndex zoneId, int transferIndex, const ParsedFindableLocation* location, const ZoneGuideConnection* connection)
-		: zoneId(zoneId), transferTypeIndex(transferIndex), location(location), connection(connection) {}
+	int zoneIdentifier = 0;                   // picks between connections into the same zone
+	const ZoneGuideConnection* connection = nullptr; // only compared, never dereferenced
+	std::string teleport;                     // name of the teleport to use, if any
+
+	ZonePathNode(EQZoneIndex zoneId, int transferIndex, int zoneIdentifier, const ZoneGuideConnection* connection,
+		std::string teleport = {})
+		: zoneId(zoneId), transferTypeIndex(transferIndex), zoneIdentifier(zoneIdentifier), connection(connection)
+		, teleport(std::move(teleport)) {}
 	ZonePathNode(const ZonePathData& data)
 		: zoneId(data.zoneId), transferTypeIndex(data.transferTypeIndex) {}
 };
 
+// Number of alternative routes kept with a /travelto.
+constexpr int MaxZonePathAlternatives = 3;
+
+// Another way to get to the same destination, used when a connection on the route turns out to be broken.
+struct ZonePathAlternative
+{
+	std::vector<ZonePathNode> zonePath;
+	uint32_t cost = 0;                // zone count or estimated travel time, depending on the routing mode
+};
+
 struct ZonePathRequest
 {
 	std::vector<ZonePathNode> zonePath;
 	std::string targetQuery;
+	std::vector<ZonePathAlternative> alternatives;
+	int nodesExpanded = -1;                   // zones the search looked at, or -1 if it came from the route cache
 
 	void clear()
 	{
 		zonePath.clear();
 		targetQuery.clear();
+		alternatives.clear();
+		nodesExpanded = -1;
 	}
 };
 
-std::vector<ZonePathNode> ZonePath_GeneratePath(EQZoneIndex fromZone, EQZoneIndex toZone, std::string& outputMessage);
+std::vector<ZonePathNode> ZonePath_GeneratePath(EQZoneIndex fromZone, EQZoneIndex toZone, std::string& outputMessage,
+	int* nodesExpanded = nullptr);
+std::vector<ZonePathAlternative> ZonePath_GenerateAlternatives(EQZoneIndex fromZone, EQZoneIndex toZone,
+	const std::vector<ZonePathNode>& primaryPath, int count);
+
+// Called from the pulse with the generated path, or an empty path and a message if none was found.
+using ZonePathCallback = std::function<void(ZonePathRequest& request, const std::string& message)>;
+
+// Generates a path and up to alternativeCount alternatives on a worker thread. Set `activates` if the
+// callback makes the path active. Such a request is dropped without calling back if another path is
+// made active, another such request is made, or /travelto is stopped before it finishes.
+void ZonePath_GeneratePathAsync(EQZoneIndex fromZone, EQZoneIndex toZone, int alternativeCount, ZonePathCallback callback,
+	bool activates = false);
+
+// Generates a path to whichever of toZones is closest on a worker thread, without alternatives.
+void ZonePath_GenerateNearestPathAsync(EQZoneIndex fromZone, const std::vector<EQZoneIndex>& toZones, ZonePathCallback callback,
+	bool activates = false);
 void ZonePath_SetActive(const ZonePathRequest& zonePathData, bool travel);
 void ZonePath_OnPulse();
 void ZonePath_NavCanceled(bool message);
@@ -132,3 +180,9 @@ void ZonePath_FollowActive();
 void ZonePath_Stop();
 void ZonePath_DumpConnections();
 bool ZonePath_IsActive();
+void ZonePath_InvalidateGraph();
+void ZonePath_Shutdown();
+void ZonePath_Benchmark();
+void ZonePath_BenchmarkSuite(std::string_view args);
+void ZonePath_CastTeleportSpell(const ParsedTeleport& teleport);
+void ZonePath_CastRequestedTeleportSpell(std::string_view spell);
@@ -39,6 +39,20 @@ const char* GetConfiguredColorDescription(ConfiguredColor color)
 	}
 }
 
+// Estimated travel time, in seconds, of using each type of transfer. Anything not listed here
+// uses DefaultTransferTypeCost. These can be overridden with TransferTypeCosts in EasyFind.yaml
+static constexpr int DefaultTransferTypeCost = 15;
+static const std::vector<std::pair<const char*, int>> s_defaultTransferTypeCosts = {
+	{ "Zone Line", 10 },
+	{ "Door", 12 },
+	{ "Keyed Door", 15 },
+	{ "Translocator", 10 },
+	{ "Boat", 120 },
+	{ "Wizard's Spire", 30 },
+	{ "Magus", 30 },
+	{ "Priest of Discord", 30 },
+};
+
 static const std::vector<std::pair<ConfiguredGroupPlugin, const char*>> s_groupPluginNames = {
 	{ ConfiguredGroupPlugin::Auto, "auto" },
 	{ ConfiguredGroupPlugin::Dannet, "dannet" },
@@ -104,6 +118,30 @@ namespace YAML
 		}
 	};
 
+	template <>
+	struct convert<ZonePathRoutingMode> {
+		static Node encode(ZonePathRoutingMode data) {
+			Node node;
+
+			node = ZonePathRoutingModeToString(data);
+			return node;
+		}
+		static bool decode(const Node& node, ZonePathRoutingMode& data) {
+			if (!node.IsScalar())
+				return false;
+			std::string nodeValue = node.as<std::string>(std::string());
+			for (int i = 0; i < (int)ZonePathRoutingMode::Max; ++i)
+			{
+				if (ci_equals(nodeValue, ZonePathRoutingModeToString((ZonePathRoutingMode)i)))
+				{
+					data = (ZonePathRoutingMode)i;
+					return true;
+				}
+			}
+			return false;
+		}
+	};
+
 	template <>
 	struct convert<mq::MQColor> {
 		static Node encode(const mq::MQColor& data) {
@@ -240,11 +278,16 @@ void EasyFindConfiguration::ReloadSettings()
 {
 	SPDLOG_INFO("Reloading settings");
 	LoadSettings();
+
+	if (ZoneGuideManagerClient::Instance().zoneGuideDataSet)
+		RefreshTransferTypes();
 }
 
 void EasyFindConfiguration::ResetSettings()
 {
 	m_disabledTransferTypesPrefs.clear();
+	m_transferTypeCostPrefs.clear();
+	m_routingMode = ZonePathRoutingMode::FewestZones;
 	m_configuredColors = s_defaultColors;
 	m_navLogLevel = spdlog::level::err;
 	m_chatSink->set_level(spdlog::level::info);
@@ -254,9 +297,16 @@ void EasyFindConfiguration::ResetSettings()
 	m_silentGroupCommands = true;
 	m_verboseMessages = false;
 	m_ignoreZoneConnectionDataEnabled = false;
+	m_bidirectionalSearchEnabled = false;
 
 	m_configNode = YAML::Node();
 	SaveSettings();
+
+	// Put the transfer type settings back to their defaults too, not just the preferences.
+	if (ZoneGuideManagerClient::Instance().zoneGuideDataSet)
+		RefreshTransferTypes();
+	else
+		ZonePath_InvalidateGraph();
 }
 
 void EasyFindConfiguration::LoadSettings()
@@ -282,12 +332,14 @@ void EasyFindConfiguration::LoadSettings()
 		LoadDisabledTransferTypes();
 
 		m_groupPluginSelection = m_configNode["GroupPlugin"].as<ConfiguredGroupPlugin>(ConfiguredGroupPlugin::Auto);
+		m_routingMode = m_configNode["RoutingMode"].as<ZonePathRoutingMode>(ZonePathRoutingMode::FewestZones);
 
 		m_coloredFindWindowEnabled = m_configNode["ColoredFindWindow"].as<bool>(true);
 		m_distanceColumnEnabled = m_configNode["DistanceColumn"].as<bool>(true);
 		m_silentGroupCommands = m_configNode["SilentGroupCommands"].as<bool>(true);
 		m_verboseMessages = m_configNode["VerboseMessages"].as<bool>(false);
 		m_ignoreZoneConnectionDataEnabled = m_configNode["IgnoreZoneConnectionData"].as<bool>(false);
+		m_bidirectionalSearchEnabled = m_configNode["BidirectionalSearch"].as<bool>(false);
 	}
 	catch (const YAML::ParserException& ex)
 	{
@@ -413,6 +465,14 @@ void EasyFindConfiguration::SetIgnoreZoneConnectionDataEnabled(bool ignore)
 	SaveSettings();
 }
 
+void EasyFindConfiguration::SetBidirectionalSearchEnabled(bool enable)
+{
+	m_bidirectionalSearchEnabled = enable;
+	m_configNode["BidirectionalSearch"] = enable;
+
+	SaveSettings();
+}
+
 //----------------------------------------------------------------------------
 
 void EasyFindConfiguration::RefreshTransferTypes()
@@ -485,6 +545,29 @@ void EasyFindConfiguration::RefreshTransferTypes()
 
 		m_disabledTransferTypes[i] = false;
 	}
+
+	// Travel time estimates for weighted routing
+	m_transferTypeCosts.resize(numTransferTypes);
+	for (int i = 0; i < numTransferTypes; ++i)
+	{
+		std::string description{ mgr.transferTypes[i].description };
+		m_transferTypeCosts[i] = DefaultTransferTypeCost;
+
+		for (const auto& [name, cost] : s_defaultTransferTypeCosts)
+		{
+			if (description == name)
+			{
+				m_transferTypeCosts[i] = cost;
+				break;
+			}
+		}
+
+		auto iter = m_transferTypeCostPrefs.find(description);
+		if (iter != m_transferTypeCostPrefs.end())
+			m_transferTypeCosts[i] = iter->second;
+	}
+
+	ZonePath_InvalidateGraph();
 }
 
 void EasyFindConfiguration::LoadDisabledTransferTypes()
@@ -498,6 +581,8 @@ void EasyFindConfiguration::LoadDisabledTransferTypes()
 	}
 
 	m_disabledTransferTypesPrefs = std::move(disabledTransferTypes);
+
+	m_transferTypeCostPrefs = m_configNode["TransferTypeCosts"].as<std::map<std::string, int>>(std::map<std::string, int>());
 }
 
 bool EasyFindConfiguration::IsSupportedTransferType(int transferTypeIndex) const
@@ -525,6 +610,7 @@ void EasyFindConfiguration::SetDisabledTransferType(int transferTypeIndex, bool
 		return;
 
 	m_disabledTransferTypes[transferTypeIndex] = disabled;
+	ZonePath_InvalidateGraph();
 
 	CXStr transferTypeName = ZoneGuideManagerClient::Instance().GetZoneTransferTypeNameByIndex(transferTypeIndex);
 
@@ -553,6 +639,42 @@ void EasyFindConfiguration::SetDisabledTransferType(int transferTypeIndex, bool
 	SaveSettings();
 }
 
+int EasyFindConfiguration::GetTransferTypeCost(int transferTypeIndex) const
+{
+	if (transferTypeIndex < 0 || transferTypeIndex >= (int)m_transferTypeCosts.size())
+		return DefaultTransferTypeCost;
+
+	return m_transferTypeCosts[transferTypeIndex];
+}
+
+void EasyFindConfiguration::SetTransferTypeCost(int transferTypeIndex, int cost)
+{
+	if (transferTypeIndex < 0 || transferTypeIndex >= (int)m_transferTypeCosts.size())
+		return;
+
+	CXStr transferTypeName = ZoneGuideManagerClient::Instance().GetZoneTransferTypeNameByIndex(transferTypeIndex);
+	if (transferTypeName.empty())
+		return;
+
+	m_transferTypeCosts[transferTypeIndex] = std::max(cost, 1);
+	m_transferTypeCostPrefs[std::string(transferTypeName)] = m_transferTypeCosts[transferTypeIndex];
+	m_configNode["TransferTypeCosts"] = m_transferTypeCostPrefs;
+
+	SaveSettings();
+
+	ZonePath_InvalidateGraph();
+}
+
+void EasyFindConfiguration::SetRoutingMode(ZonePathRoutingMode mode)
+{
+	m_routingMode = mode;
+	m_configNode["RoutingMode"] = mode;
+
+	SaveSettings();
+
+	ZonePath_InvalidateGraph();
+}
+
 //----------------------------------------------------------------------------
 
 ConfiguredGroupPlugin EasyFindConfiguration::GetPreferredGroupPlugin() const
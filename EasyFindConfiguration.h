@@ -1,6 +1,8 @@
 
 #pragma once
 
+#include "EasyFind.h"
+
 #include <mq/Plugin.h>
 
 #include <spdlog/common.h>
@@ -73,11 +75,20 @@ public:
 	void SetIgnoreZoneConnectionDataEnabled(bool ignore);
 	bool IsIgnoreZoneConnectionDataEnabled() const { return m_ignoreZoneConnectionDataEnabled; }
 
+	void SetBidirectionalSearchEnabled(bool enable);
+	bool IsBidirectionalSearchEnabled() const { return m_bidirectionalSearchEnabled; }
+
 	// transfer types
 	void RefreshTransferTypes();
 	bool IsSupportedTransferType(int transferTypeIndex) const;
 	bool IsDisabledTransferType(int transferTypeIndex) const;
 	void SetDisabledTransferType(int transferTypeIndex, bool disabled);
+	int GetTransferTypeCost(int transferTypeIndex) const;
+	void SetTransferTypeCost(int transferTypeIndex, int cost);
+
+	// zone path routing
+	ZonePathRoutingMode GetRoutingMode() const { return m_routingMode; }
+	void SetRoutingMode(ZonePathRoutingMode mode);
 
 	// group execution behaviors
 	bool IsEQBCLoaded() const { return m_eqbcLoaded; }
@@ -102,6 +113,8 @@ private:
 	std::vector<std::string> m_disabledTransferTypesPrefs; // user pref
 	std::vector<bool> m_supportedTransferTypes;            // hardcoded disabled, converted to index when data is loaded
 	std::vector<bool> m_disabledTransferTypes;             // converted to index when data is loaded
+	std::map<std::string, int> m_transferTypeCostPrefs;    // user pref
+	std::vector<int> m_transferTypeCosts;                  // converted to index when data is loaded
 
 	std::shared_ptr<spdlog::sinks::sink> m_chatSink;
 	std::array<MQColor, (size_t)ConfiguredColor::MaxColors> m_configuredColors;
@@ -111,12 +124,14 @@ private:
 	bool m_eqbcLoaded = false;
 	bool m_dannetLoaded = false;
 	ConfiguredGroupPlugin m_groupPluginSelection = ConfiguredGroupPlugin::Auto;
+	ZonePathRoutingMode m_routingMode = ZonePathRoutingMode::FewestZones;
 
 	bool m_distanceColumnEnabled = true;
 	bool m_coloredFindWindowEnabled = true;
 	bool m_silentGroupCommands = true;
 	bool m_verboseMessages = false;
 	bool m_ignoreZoneConnectionDataEnabled = false;
+	bool m_bidirectionalSearchEnabled = false;
 };
 
 extern EasyFindConfiguration* g_configuration;
@@ -3,6 +3,8 @@
 #include "EasyFindConfiguration.h"
 #include "EasyFindWindow.h"
 #include "EasyFindZoneConnections.h"
+#include "EasyFindZoneContraction.h"
+#include "EasyFindZoneGraph.h"
 
 #include "imgui/ImGuiUtils.h"
 #include "imgui/ImGuiTextEditor.h"
@@ -109,6 +111,8 @@ static void DrawEasyFindWindowConnections()
 	ImGui::Checkbox("Show Zone Lines", &showZoneLines); ImGui::SameLine();
 	ImGui::Checkbox("Show Switches", &showZoneSwitches); ImGui::SameLine();
 	ImGui::Checkbox("Show Translocators", &showTranslocators);
+	ImGui::TextDisabled("Zone connections loaded from %s in %.2f ms",
+		g_zoneConnections->IsLoadedFromCache() ? "cache" : "YAML", g_zoneConnections->GetLoadTime());
 	ImGui::Separator();
 
 	ImGui::BeginGroup();
@@ -549,13 +553,30 @@ static void DrawEasyFindZonePathGeneration()
 	ImGui::Text("To Zone:"); ImGui::SameLine(0.0f, 4.0f); ZoneLabel(pToZone ? pToZone->Id : -1);
 
 	static std::vector<ZonePathNode> s_zonePathTest;
+	static std::vector<ZonePathAlternative> s_zonePathAlternatives;
 	static std::string message;
+	static int s_nodesExpanded = -1;
+	static bool s_generating = false;
 
-	if (ImGui::Button("Generate"))
+	ImGui::BeginDisabled(s_generating);
+	bool generate = ImGui::Button(s_generating ? "Generating..." : "Generate");
+	ImGui::EndDisabled();
+
+	if (generate)
 	{
 		if (pFromZone && pToZone)
 		{
-			s_zonePathTest = ZonePath_GeneratePath(pFromZone->Id, pToZone->Id, message);
+			s_generating = true;
+
+			ZonePath_GeneratePathAsync(pFromZone->Id, pToZone->Id, MaxZonePathAlternatives,
+				[](ZonePathRequest& request, const std::string& resultMessage)
+				{
+					s_zonePathTest = std::move(request.zonePath);
+					s_zonePathAlternatives = std::move(request.alternatives);
+					s_nodesExpanded = request.nodesExpanded;
+					message = resultMessage;
+					s_generating = false;
+				});
 		}
 	}
 
@@ -565,6 +586,8 @@ static void DrawEasyFindZonePathGeneration()
 	{
 		message.clear();
 		s_zonePathTest.clear();
+		s_zonePathAlternatives.clear();
+		s_nodesExpanded = -1;
 	}
 
 	if (!message.empty())
@@ -572,6 +595,22 @@ static void DrawEasyFindZonePathGeneration()
 		ImGui::TextColored(ImColor(255, 255, 0), "%s", message.c_str());
 	}
 
+	if (!s_zonePathTest.empty())
+	{
+		if (s_nodesExpanded >= 0)
+			ImGui::Text("Zones expanded: %d", s_nodesExpanded);
+		else
+			ImGui::Text("Zones expanded: none, from the route cache");
+	}
+
+	ZoneRouteCacheStats cacheStats = ZonePath_GetRouteCacheStats();
+	ImGui::Text("Route cache: %u routes, %u hits, %u misses", cacheStats.entries, cacheStats.hits, cacheStats.misses);
+	ImGui::SameLine();
+	if (ImGui::SmallButton("Clear Cache"))
+	{
+		ZonePath_ClearRouteCache();
+	}
+
 	if (!s_zonePathTest.empty())
 	{
 		if (ImGui::BeginTable("##Entries", 2))
@@ -609,9 +648,201 @@ static void DrawEasyFindZonePathGeneration()
 		{
 			ZonePathRequest req;
 			req.zonePath = s_zonePathTest;
+			req.alternatives = s_zonePathAlternatives;
 
 			ZonePath_SetActive(req, true);
 		}
+
+		if (!s_zonePathAlternatives.empty())
+		{
+			ImGui::Text("Alternatives:");
+
+			if (ImGui::BeginTable("##Alternatives", 2))
+			{
+				ImGui::TableSetupColumn("Cost", ImGuiTableColumnFlags_WidthFixed);
+				ImGui::TableSetupColumn("Route");
+				ImGui::TableHeadersRow();
+
+				for (const ZonePathAlternative& alternative : s_zonePathAlternatives)
+				{
+					ImGui::TableNextRow();
+
+					ImGui::TableNextColumn();
+					ImGui::Text("%u", alternative.cost);
+
+					ImGui::TableNextColumn();
+					for (size_t i = 0; i < alternative.zonePath.size(); ++i)
+					{
+						if (i > 0)
+						{
+							ImGui::SameLine(0.0f, 4.0f);
+							ImGui::TextUnformatted("->");
+							ImGui::SameLine(0.0f, 4.0f);
+						}
+
+						ZoneLabel(alternative.zonePath[i].zoneId);
+					}
+				}
+
+				ImGui::EndTable();
+			}
+		}
+	}
+
+	ImGui::Separator();
+
+	if (ImGui::CollapsingHeader("Hop Counts From Starting Zone"))
+	{
+		std::shared_ptr<const ZoneGraph> currentGraph = ZonePath_GetGraph();
+		std::shared_ptr<const ZoneEdgeMask> edgeMask = ZonePath_GetEdgeMask();
+		ZoneOrdinal fromOrdinal = currentGraph && pFromZone ? currentGraph->GetOrdinal(pFromZone->Id) : InvalidZoneOrdinal;
+
+		if (!currentGraph || !edgeMask)
+		{
+			ImGui::TextColored(ImColor(255, 255, 0), "Zone data is not loaded.");
+		}
+		else if (fromOrdinal == InvalidZoneOrdinal)
+		{
+			ImGui::TextColored(ImColor(255, 255, 0), "Select a starting zone that is part of the zone graph.");
+		}
+		else
+		{
+			const ZoneGraph& graph = *currentGraph;
+
+			// Hop counts are the fewest zone transfers, whatever the routing mode, so search for them here.
+			static ZoneGraphSearchState s_hopSearch;
+			graph.BreadthFirstSearch(fromOrdinal, InvalidZoneOrdinal, *edgeMask, s_hopSearch);
+			const std::vector<int>& hopCounts = s_hopSearch.depth;
+
+			// Sort the reachable zones by hop count
+			std::vector<ZoneOrdinal> destinations;
+			destinations.reserve(graph.GetNodeCount());
+
+			for (int i = 0; i < graph.GetNodeCount(); ++i)
+			{
+				if (i != fromOrdinal && hopCounts[i] > 0)
+					destinations.push_back((ZoneOrdinal)i);
+			}
+
+			std::stable_sort(destinations.begin(), destinations.end(),
+				[&](ZoneOrdinal a, ZoneOrdinal b) { return hopCounts[a] < hopCounts[b]; });
+
+			ImGui::Text("%d of %d zones are reachable", (int)destinations.size(), graph.GetNodeCount() - 1);
+
+			// Only one of these is built for the routing mode, see ZonePath_UpdateRoutingTable.
+			if (std::shared_ptr<const ZoneRoutingTable> routingTable = ZonePath_GetRoutingTable())
+			{
+				ImGui::TextDisabled("Routing table built in %.2f ms on %d threads", routingTable->GetBuildTime(),
+					routingTable->GetBuildThreadCount());
+			}
+
+			if (std::shared_ptr<const ZoneContractionMetric> metric = ZonePath_GetContractionMetric())
+			{
+				const ZoneContraction& contraction = *metric->GetContraction();
+				ImGui::TextDisabled("Contraction has %d shortcuts, built in %.2f ms and customized in %.2f ms",
+					contraction.GetShortcutCount(), contraction.GetBuildTime(), metric->GetCustomizeTime());
+			}
+
+			if (ImGui::BeginTable("##HopCounts", 2, ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg,
+				ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * 15)))
+			{
+				ImGui::TableSetupColumn("Zone");
+				ImGui::TableSetupColumn("Hops", ImGuiTableColumnFlags_WidthFixed, 50.0f);
+				ImGui::TableSetupScrollFreeze(0, 1);
+				ImGui::TableHeadersRow();
+
+				ImGuiListClipper clipper;
+				clipper.Begin((int)destinations.size());
+
+				while (clipper.Step())
+				{
+					for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
+					{
+						ZoneOrdinal ordinal = destinations[row];
+
+						ImGui::TableNextRow();
+
+						ImGui::TableNextColumn();
+						ZoneLabel(graph.GetNode(ordinal).zoneId);
+
+						ImGui::TableNextColumn();
+						ImGui::Text("%d", hopCounts[ordinal]);
+					}
+				}
+
+				ImGui::EndTable();
+			}
+		}
+	}
+
+	if (ImGui::CollapsingHeader("Unreachable From Current Zone"))
+	{
+		std::shared_ptr<const ZoneReachability> reachability = ZonePath_GetReachability();
+		EQZoneIndex currentZone = pWorldData->GetZoneBaseId(ZoneGuideManagerClient::Instance().currentZone);
+		ZoneOrdinal fromOrdinal = reachability ? reachability->GetGraph()->GetOrdinal(currentZone) : InvalidZoneOrdinal;
+
+		if (!reachability)
+		{
+			ImGui::TextColored(ImColor(255, 255, 0), "Zone data is not loaded.");
+		}
+		else if (fromOrdinal == InvalidZoneOrdinal)
+		{
+			ImGui::TextColored(ImColor(255, 255, 0), "The current zone is not part of the zone graph.");
+		}
+		else
+		{
+			const ZoneGraph& graph = *reachability->GetGraph();
+
+			std::vector<ZoneOrdinal> unreachable;
+			for (int i = 0; i < graph.GetNodeCount(); ++i)
+			{
+				if (!reachability->CanReach(fromOrdinal, (ZoneOrdinal)i))
+					unreachable.push_back((ZoneOrdinal)i);
+			}
+
+			ImGui::Text("%d of %d zones can't be reached", (int)unreachable.size(), graph.GetNodeCount() - 1);
+			ImGui::TextDisabled("%d connected components", reachability->GetComponentCount());
+
+			if (ImGui::BeginTable("##Unreachable", 2, ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg,
+				ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * 15)))
+			{
+				ImGui::TableSetupColumn("Zone");
+				ImGui::TableSetupColumn("Reason", ImGuiTableColumnFlags_WidthFixed, 50.0f);
+				ImGui::TableSetupScrollFreeze(0, 1);
+				ImGui::TableHeadersRow();
+
+				ImGuiListClipper clipper;
+				clipper.Begin((int)unreachable.size());
+
+				while (clipper.Step())
+				{
+					for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
+					{
+						ZoneOrdinal ordinal = unreachable[row];
+
+						ImGui::TableNextRow();
+
+						ImGui::TableNextColumn();
+						ZoneLabel(graph.GetNode(ordinal).zoneId);
+
+						ImGui::TableNextColumn();
+						ImGui::TextDisabled("(?)");
+
+						// Only work out the reason for the row being looked at.
+						if (ImGui::IsItemHovered())
+						{
+							ImGui::BeginTooltip();
+							ImGui::PushTextWrapPos(ImGui::GetFontSize() * 35.0f);
+							ImGui::TextUnformatted(reachability->DescribeBoundary(fromOrdinal, ordinal).c_str());
+							ImGui::PopTextWrapPos();
+							ImGui::EndTooltip();
+						}
+					}
+				}
+
+				ImGui::EndTable();
+			}
+		}
 	}
 }
 
@@ -753,6 +984,63 @@ void DrawEasyFindSettingsPanel()
 		g_configuration->SetVerboseMessages(verboseMessages);
 	HelpLabel("If checked, some messages will contain additional status information");
 
+	bool bidirectionalSearch = g_configuration->IsBidirectionalSearchEnabled();
+	if (ImGui::Checkbox("Bidirectional route search", &bidirectionalSearch))
+		g_configuration->SetBidirectionalSearchEnabled(bidirectionalSearch);
+	HelpLabel("If checked, routes are searched from both ends at once while the routing table is being built. "
+		"This is faster for long routes, but may not prefer lower level zones when routes are otherwise equal.");
+
+	ZonePathRoutingMode routingMode = g_configuration->GetRoutingMode();
+
+	ImGui::SetNextItemWidth(150.0f);
+	if (ImGui::BeginCombo("##Routing Mode", ZonePathRoutingModeDescription(routingMode), ImGuiComboFlags_HeightSmall))
+	{
+		for (int i = 0; i < (int)ZonePathRoutingMode::Max; ++i)
+		{
+			ZonePathRoutingMode mode = (ZonePathRoutingMode)i;
+			const bool is_selected = mode == routingMode;
+
+			if (ImGui::Selectable(ZonePathRoutingModeDescription(mode), is_selected))
+			{
+				g_configuration->SetRoutingMode(mode);
+				routingMode = mode;
+			}
+
+			if (is_selected)
+				ImGui::SetItemDefaultFocus();
+		}
+
+		ImGui::EndCombo();
+	}
+
+	ImGui::SameLine();
+	ImGui::Text("Travel Routing Mode");
+	HelpLabel("Fewest Zones picks the route with the fewest zone transfers. Fastest Travel picks the route with the "
+		"lowest estimated travel time, based on the type of each transfer and, where connection coordinates are known, "
+		"the distance run across each zone. Travel time estimates can be changed with "
+		"TransferTypeCosts in EasyFind.yaml, or per connection with cost in ZoneConnections.yaml. Lowest Level Zones "
+		"picks the route whose highest level zone is lowest, then the one with the fewest zone transfers.");
+
+	if (routingMode == ZonePathRoutingMode::FastestTravel && ZoneGuideManagerClient::Instance().zoneGuideDataSet
+		&& ImGui::TreeNode("Travel time estimates"))
+	{
+		ZoneGuideManagerClient& mgr = ZoneGuideManagerClient::Instance();
+
+		for (int i = 0; i < mgr.transferTypes.GetCount(); ++i)
+		{
+			if (!g_configuration->IsSupportedTransferType(i))
+				continue;
+
+			int cost = g_configuration->GetTransferTypeCost(i);
+
+			ImGui::SetNextItemWidth(100.0f);
+			if (ImGui::InputInt(mgr.GetZoneTransferTypeNameByIndex(i).c_str(), &cost, 1, 10, ImGuiInputTextFlags_EnterReturnsTrue))
+				g_configuration->SetTransferTypeCost(i, cost);
+		}
+
+		ImGui::TreePop();
+	}
+
 	ImGui::NewLine();
 	ImGui::Text("Colors:");
 	for (int i = 0; i < (int)ConfiguredColor::MaxColors; ++i)
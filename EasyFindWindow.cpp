@@ -101,7 +101,7 @@ int CFindLocationWndOverride::OnProcessFrame()
 	{
 		if (sm_queuedZoneId != 0)
 		{
-			FindZoneConnectionByZoneIndex(sm_queuedZoneId, sm_queuedGroupParam);
+			FindZoneConnectionByZoneIndex(sm_queuedZoneId, sm_queuedGroupParam, sm_queuedZoneIdentifier);
 		}
 		else
 		{
@@ -111,6 +111,7 @@ int CFindLocationWndOverride::OnProcessFrame()
 		sm_queuedSearchTerm.clear();
 		sm_queuedGroupParam = false;
 		sm_queuedZoneId = 0;
+		sm_queuedZoneIdentifier = 0;
 	}
 
 	if (updateColors)
@@ -845,33 +846,41 @@ void CFindLocationWndOverride::FindLocationByRefNum(int refNum, bool group)
 	SPDLOG_ERROR("Couldn't find location by ref: {}", refNum);
 }
 
-bool CFindLocationWndOverride::FindZoneConnectionByZoneIndex(EQZoneIndex zoneId, bool group)
+bool CFindLocationWndOverride::FindZoneConnectionByZoneIndex(EQZoneIndex zoneId, bool group, int zoneIdentifier)
 {
 	if (!sm_customLocationsAdded)
 	{
-		sm_queuedZoneId = sm_queuedZoneId;
+		sm_queuedZoneId = zoneId;
+		sm_queuedZoneIdentifier = zoneIdentifier;
 		sm_queuedGroupParam = group;
 
 		SPDLOG_WARN("Waiting for connections to be loaded!");
 		return true;
 	}
 
-	// look for exact match by zone id
-	int foundIndex = FindClosestLocation(
-		[&](int index)
-		{
-			int refId = (int)findLocationList->GetItemData(index);
-			FindableReference* ref = referenceList.FindFirst(refId);
-			if (!ref) return false;
-
-			if (ref->type == FindLocation_Location || ref->type == FindLocation_Switch)
+	auto findByZone = [&](bool matchIdentifier)
+	{
+		return FindClosestLocation(
+			[&](int index)
 			{
-				FindZoneConnectionData& connData = unfilteredZoneConnectionList[ref->index];
-				return connData.zoneId == zoneId;
-			}
+				int refId = (int)findLocationList->GetItemData(index);
+				FindableReference* ref = referenceList.FindFirst(refId);
+				if (!ref) return false;
 
-			return false;
-		});
+				if (ref->type == FindLocation_Location || ref->type == FindLocation_Switch)
+				{
+					FindZoneConnectionData& connData = unfilteredZoneConnectionList[ref->index];
+					return connData.zoneId == zoneId && (!matchIdentifier || connData.zoneIdentifier == zoneIdentifier);
+				}
+
+				return false;
+			});
+	};
+
+	// look for exact match by zone id, preferring the connection the route was planned through
+	int foundIndex = zoneIdentifier > 0 ? findByZone(true) : -1;
+	if (foundIndex == -1)
+		foundIndex = findByZone(false);
 
 	if (foundIndex == -1)
 	{
@@ -92,7 +92,9 @@ public:
 		return closestIndex;
 	}
 
-	bool FindZoneConnectionByZoneIndex(EQZoneIndex zoneId, bool group);
+	// Finds the closest connection to a zone. If zoneIdentifier is set, a connection with that
+	// identifier is preferred, since it decides where in the zone we arrive.
+	bool FindZoneConnectionByZoneIndex(EQZoneIndex zoneId, bool group, int zoneIdentifier = 0);
 	bool FindLocation(std::string_view searchTerm, bool group);
 
 	void AddDistanceColumn();
@@ -126,6 +128,7 @@ private:
 	static inline std::string sm_queuedSearchTerm;
 	static inline bool sm_queuedGroupParam = false;
 	static inline EQZoneIndex sm_queuedZoneId = 0;
+	static inline int sm_queuedZoneIdentifier = 0;
 
 	// tracking for options changes
 	static inline bool sm_displayDistanceColumn = true;
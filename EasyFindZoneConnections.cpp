@@ -2,8 +2,11 @@
 #include "EasyFind.h"
 #include "EasyFindConfiguration.h"
 #include "EasyFindZoneConnections.h"
+#include "EasyFindZoneConnectionsCache.h"
 
+#include <charconv>
 #include <fstream>
+#include <set>
 
 namespace fs = std::filesystem;
 
@@ -23,6 +26,19 @@ ZoneConnections* g_zoneConnections = nullptr;
 
 //============================================================================
 
+EQZoneIndex ResolveTargetZoneName(const std::string& targetZone)
+{
+	// read zone name (or id)
+	int zoneId = 0;
+	auto [ptr, ec] = std::from_chars(targetZone.data(), targetZone.data() + targetZone.size(), zoneId);
+	if (ec != std::errc() || ptr != targetZone.data() + targetZone.size())
+		zoneId = GetZoneID(targetZone.c_str());
+
+	return (EQZoneIndex)zoneId;
+}
+
+//============================================================================
+
 namespace YAML
 {
 	template <>
@@ -60,14 +76,8 @@ namespace YAML
 			}
 
 			data.keyword = node["keyword"].as<std::string>(std::string());
-
-			// read zone name (or id)
-			int zoneId = node["targetZone"].as<int>(0);
-			if (zoneId == 0)
-			{
-				zoneId = GetZoneID(node["targetZone"].as<std::string>().c_str());
-			}
-			data.zoneId = (EQZoneIndex)zoneId;
+			data.targetZone = node["targetZone"].as<std::string>();
+			data.zoneId = ResolveTargetZoneName(data.targetZone);
 			data.zoneIdentifier = node["identifier"].as<int>(0);
 			return true;
 		}
@@ -100,6 +110,8 @@ namespace YAML
 					data.requiredAchievementName = achievementNode.as<std::string>(std::string());
 			}
 
+			data.cost = node["cost"].as<int>(-1);
+
 			data.typeString = node["type"].as<std::string>();
 			if (ci_equals(data.typeString, "ZoneConnection"))
 			{
@@ -129,13 +141,8 @@ namespace YAML
 					}
 				}
 
-				// read zone name (or id)
-				int zoneId = node["targetZone"].as<int>(0);
-				if (zoneId == 0)
-				{
-					zoneId = GetZoneID(node["targetZone"].as<std::string>().c_str());
-				}
-				data.zoneId = (EQZoneIndex)zoneId;
+				data.targetZone = node["targetZone"].as<std::string>();
+				data.zoneId = ResolveTargetZoneName(data.targetZone);
 				data.zoneIdentifier = node["identifier"].as<int>(0);
 				data.replace = node["replace"].as<bool>(true);
 				data.remove = node["remove"].as<bool>(false);
@@ -167,6 +174,34 @@ namespace YAML
 		}
 	};
 
+	template <>
+	struct convert<ParsedTeleport> {
+		static Node encode(const ParsedTeleport& data) {
+			return Node();
+		}
+		static bool decode(const Node& node, ParsedTeleport& data) {
+			if (!node.IsMap()) {
+				return false;
+			}
+
+			data.name = node["name"].as<std::string>(std::string());
+			data.command = node["command"].as<std::string>(std::string());
+			data.spell = node["spell"].as<std::string>(std::string());
+			data.classes = node["classes"].as<std::vector<std::string>>(std::vector<std::string>());
+			data.level = node["level"].as<int>(0);
+			data.targetZone = node["targetZone"].as<std::string>(std::string());
+			data.condition = node["condition"].as<std::string>(std::string());
+			data.castTime = node["castTime"].as<int>(0);
+			data.cooldown = node["cooldown"].as<int>(0);
+			data.cost = node["cost"].as<int>(-1);
+
+			if (data.name.empty())
+				data.name = data.spell;
+
+			return (!data.command.empty() || !data.spell.empty()) && !data.targetZone.empty();
+		}
+	};
+
 	// std::map
 	template <typename K, typename V, typename C>
 	struct convert<std::map<K, V, C>> {
@@ -206,6 +241,12 @@ bool ParsedFindableLocation::IsZoneConnection() const
 }
 
 bool ParsedFindableLocation::CheckRequirements() const
+{
+	return CheckFindableLocationRequirements(requiredExpansions, requiredAchievement, requiredAchievementName);
+}
+
+bool CheckFindableLocationRequirements(EQExpansionOwned requiredExpansions, int requiredAchievement,
+	const std::string& requiredAchievementName)
 {
 	// check expansion. We only track the expansion num so convert to flags and check that its set.
 	if (requiredExpansions != 0)
@@ -236,180 +277,873 @@ bool ParsedFindableLocation::CheckRequirements() const
 	return true;
 }
 
-ZoneConnections::ZoneConnections(const std::string& easyfindDirectory)
-	: m_easyfindDir(easyfindDirectory)
+// Reads the whole file so that it can be both parsed and hashed.
+static std::string ReadFileContents(const std::string& fileName)
 {
-	std::error_code ec;
-	if (!fs::is_directory(m_easyfindDir, ec))
+	std::ifstream file(fileName, std::ios::binary);
+	if (!file.is_open())
+		throw YAML::BadFile(fileName);
+
+	return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+EQZoneIndex ParsedTeleport::ResolveTargetZone() const
+{
+	if (ci_equals(targetZone, "bind"))
 	{
-		fs::create_directories(m_easyfindDir, ec);
+		PcProfile* pProfile = pLocalPC ? pLocalPC->GetCurrentPcProfile() : nullptr;
+		return pProfile ? pProfile->BoundLocations[0].ZoneBoundID : 0;
 	}
 
-	Load();
+	if (targetZone.find("${") != std::string::npos)
+		return GetZoneID(EvaluateMacroString(targetZone).c_str());
+
+	return GetZoneID(targetZone.c_str());
 }
 
-ZoneConnections::~ZoneConnections()
+bool ParsedTeleport::IsReady() const
 {
+	if (std::chrono::steady_clock::now() < cooldownEnd)
+		return false;
+
+	if (!spell.empty() && !FindCaster())
+		return false;
+
+	if (condition.empty())
+		return true;
+
+	return GetBoolFromString(EvaluateMacroString(condition), false);
 }
 
-void ZoneConnections::LoadOverride(std::string_view customFile)
+bool ParsedTeleport::FindCaster() const
 {
-	if (customFile.empty())
-		customFile = "ZoneConnections_Override.yaml";
+	caster.clear();
 
-	std::string configFile = (fs::path(m_easyfindDir) / customFile).string();
+	// We can see our own spellbook, so prefer casting it ourselves.
+	if (GetBoolFromString(EvaluateMacroString(fmt::format("${{Me.Book[{}]}}", spell)), false)
+		|| GetBoolFromString(EvaluateMacroString(fmt::format("${{Me.Gem[{}]}}", spell)), false))
+	{
+		caster = pLocalPC->Name;
+		return true;
+	}
 
-	if (!fs::exists(configFile))
+	// Other group members' spellbooks aren't visible, so go by class and level instead.
+	for (int i = 1; i < MAX_GROUP_SIZE; ++i)
 	{
-		// config file does not exist
-		m_zoneConnectionsOverrideConfig = {};
+		if (!GetBoolFromString(EvaluateMacroString(fmt::format("${{Group.Member[{}].Present}}", i)), false))
+			continue;
+
+		std::string className = EvaluateMacroString(fmt::format("${{Group.Member[{}].Class.ShortName}}", i));
+		if (std::none_of(classes.begin(), classes.end(), [&](const std::string& c) { return ci_equals(c, className); }))
+			continue;
+
+		int memberLevel = GetIntFromString(EvaluateMacroString(fmt::format("${{Group.Member[{}].Level}}", i)), 0);
+		if (memberLevel < level)
+			continue;
+
+		caster = EvaluateMacroString(fmt::format("${{Group.Member[{}].Name}}", i));
+		return true;
+	}
+
+	return false;
+}
+
+void ParsedTeleport::Use() const
+{
+	cooldownEnd = std::chrono::steady_clock::now() + std::chrono::seconds(cooldown);
+
+	if (spell.empty())
+	{
+		SPDLOG_INFO("Using teleport: \ag{}", name.empty() ? command : name);
+
+		DoCommand(pLocalPlayer, command.c_str());
+		return;
+	}
+
+	if (ci_equals(caster, pLocalPC->Name))
+	{
+		ZonePath_CastTeleportSpell(*this);
 		return;
 	}
 
+	SPDLOG_INFO("Asking \ag{}\ax to cast \ag{}", caster, spell);
+	DoGroupCommand(fmt::format("/travelto cast {} {}", caster, spell), false);
+}
+
+bool ParsedFindableLocation::ResolveAchievement()
+{
+	if (requiredAchievement != 0 || requiredAchievementName.empty())
+		return true;
+
+	if (const Achievement* achievement = GetAchievementByName(requiredAchievementName))
+	{
+		requiredAchievement = achievement->id;
+		return true;
+	}
+
+	return false;
+}
+
+// Hashes the text of each zone in FindLocations, and of everything else in the file, so that
+// a reload can tell which zones were edited. An entry's text runs from its key to the next key.
+static void HashZoneConnections(std::string_view contents, const YAML::Node& zoneConnectionsConfig,
+	ZoneConnectionsData& outData)
+{
+	YAML::Node findLocations = zoneConnectionsConfig["FindLocations"];
+
+	std::vector<int> keyPositions;
+	if (zoneConnectionsConfig.IsMap())
+	{
+		for (const auto& sectionNode : zoneConnectionsConfig)
+			keyPositions.push_back(sectionNode.first.Mark().pos);
+	}
+	if (findLocations.IsMap())
+	{
+		for (const auto& zoneNode : findLocations)
+			keyPositions.push_back(zoneNode.first.Mark().pos);
+	}
+	std::sort(keyPositions.begin(), keyPositions.end());
+
+	auto hashEntry = [&](const YAML::Node& key, const YAML::Node& value) -> uint64_t
+	{
+		int start = key.Mark().pos;
+		auto next = std::upper_bound(keyPositions.begin(), keyPositions.end(), start);
+		size_t end = next != keyPositions.end() ? (size_t)*next : contents.size();
+
+		// nodes that didn't come from the text don't have a position
+		if (key.Mark().is_null() || (size_t)start > end)
+			return std::hash<std::string>{}(YAML::Dump(value));
+
+		return std::hash<std::string_view>{}(contents.substr(start, end - start));
+	};
+
+	if (findLocations.IsMap())
+	{
+		for (const auto& zoneNode : findLocations)
+			outData.zoneHashes[zoneNode.first.as<std::string>()] = hashEntry(zoneNode.first, zoneNode.second);
+	}
+
+	outData.sectionsHash = 0;
+	if (zoneConnectionsConfig.IsMap())
+	{
+		for (const auto& sectionNode : zoneConnectionsConfig)
+		{
+			if (sectionNode.first.as<std::string>() != "FindLocations")
+				outData.sectionsHash = outData.sectionsHash * 31 + hashEntry(sectionNode.first, sectionNode.second);
+		}
+	}
+}
+
+// Reads one zone connections file. Zone names in the find locations are resolved to ids here, so
+// this has to wait for zone data. If `unchangedZones` is given, zones whose hash matches it are
+// skipped.
+static void ParseZoneConnections(std::string_view contents, const YAML::Node& zoneConnectionsConfig,
+	ZoneConnectionsData& outData, const ZoneHashesMap* unchangedZones = nullptr)
+{
 	try
 	{
-		m_zoneConnectionsOverrideConfig = YAML::LoadFile(configFile);
+		HashZoneConnections(contents, zoneConnectionsConfig, outData);
+
+		// Load objects from the FindLocations block
+		YAML::Node addFindLocations = zoneConnectionsConfig["FindLocations"];
+		if (addFindLocations.IsMap())
+		{
+			for (const auto& zoneNode : addFindLocations)
+			{
+				std::string zoneName = zoneNode.first.as<std::string>();
+
+				if (unchangedZones)
+				{
+					auto iter = unchangedZones->find(zoneName);
+					if (iter != unchangedZones->end() && iter->second == outData.zoneHashes[zoneName])
+						continue;
+				}
+
+				try
+				{
+					outData.findLocations[zoneName] = zoneNode.second.as<std::vector<ParsedFindableLocation>>();
+				}
+				catch (const YAML::Exception& ex)
+				{
+					// leave the zone out, so that it's picked up again once it's fixed
+					SPDLOG_ERROR("Failed to load zone connections for {}: {}", zoneName, ex.what());
+					outData.zoneHashes.erase(zoneName);
+					outData.failedZones.insert(zoneName);
+				}
+			}
+		}
 	}
-	catch (const YAML::ParserException& ex)
+	catch (const YAML::Exception& ex)
 	{
 		// failed to parse, notify and return
-		SPDLOG_ERROR("Failed to parse YAML in {}: {}", configFile, ex.what());
-		return;
+		SPDLOG_ERROR("Failed to load zone connections: {}", ex.what());
 	}
-	catch (const YAML::BadFile&)
+
+	try
 	{
-		// if we can't read the file, then ignore
-		return;
+		// Load named zone groups.
+		YAML::Node zoneGroups = zoneConnectionsConfig["ZoneGroups"];
+		if (zoneGroups.IsMap())
+		{
+			for (const auto& groupNode : zoneGroups)
+			{
+				auto& [groupName, zoneNames] = outData.zoneGroups.emplace_back();
+				groupName = groupNode.first.as<std::string>();
+
+				for (const auto& zoneNode : groupNode.second)
+					zoneNames.push_back(zoneNode.as<std::string>());
+			}
+		}
+	}
+	catch (const YAML::Exception& ex)
+	{
+		SPDLOG_ERROR("Failed to load zone groups: {}", ex.what());
+	}
+
+	// Load teleports that can be used from anywhere.
+	auto loadTeleports = [&](const char* section)
+	{
+		YAML::Node teleports = zoneConnectionsConfig[section];
+		if (teleports.IsSequence())
+		{
+			for (const auto& teleportNode : teleports)
+			{
+				ParsedTeleport teleport;
+				if (!YAML::convert<ParsedTeleport>::decode(teleportNode, teleport))
+				{
+					SPDLOG_WARN("Skipping teleport without a command, spell or targetZone: {}", teleport.name);
+					continue;
+				}
+
+				outData.teleports.push_back(std::move(teleport));
+			}
+		}
+	};
+
+	try
+	{
+		loadTeleports("Teleports");
+		loadTeleports("SpellTeleports");
+	}
+	catch (const YAML::Exception& ex)
+	{
+		SPDLOG_ERROR("Failed to load teleports: {}", ex.what());
 	}
 }
 
-void ZoneConnections::Load(std::string_view customFile)
+// Records what was read from a file, so that later edits can be told apart from it.
+static void SetFileState(ZoneConnectionsFileState& state, int64_t modifiedTime, const std::string& contents,
+	ZoneConnectionsData& data)
 {
-	if (customFile.empty())
-		customFile = "ZoneConnections.yaml";
+	state.modifiedTime = modifiedTime;
+	state.size = contents.size();
+	state.contentHash = std::hash<std::string>{}(contents);
+	state.zoneHashes = data.zoneHashes;
+	state.sectionsHash = data.sectionsHash;
+}
 
-	std::string configFile = (fs::path(m_easyfindDir) / customFile).string();
+static int64_t GetModifiedTime(const std::string& fileName)
+{
+	std::error_code ec;
+	return fs::last_write_time(fileName, ec).time_since_epoch().count();
+}
 
+// Returns true if a file still looks the way it did when it was read. A file that doesn't exist
+// matches an empty state.
+static bool IsFileUnchanged(const std::string& fileName, const ZoneConnectionsFileState& state)
+{
+	std::error_code ec;
+	uint64_t size = fs::file_size(fileName, ec);
+	if (ec)
+		return state.size == 0 && state.modifiedTime == 0;
+
+	return size == state.size && GetModifiedTime(fileName) == state.modifiedTime;
+}
+
+// Reads and parses ZoneConnections.yaml, preferring its compiled cache. Returns false if the file
+// couldn't be read or parsed.
+static bool ReadZoneConnections(const std::string& configFile, ZoneConnectionsData& outData,
+	LoadedZoneConnections& result)
+{
 	if (!fs::exists(configFile))
 	{
 		// config file does not exist
 		SPDLOG_ERROR("Config file {} was not found!", configFile);
-		return;
+		return false;
 	}
 
 	try
 	{
-		m_zoneConnectionsConfig = YAML::LoadFile(configFile);
+		// Check the time first, so that an edit made while reading is noticed later.
+		int64_t modifiedTime = GetModifiedTime(configFile);
+		std::string contents = ReadFileContents(configFile);
+
+		ZoneConnectionsSource source;
+		source.size = contents.size();
+		source.modifiedTime = modifiedTime;
+		source.contentHash = std::hash<std::string>{}(contents);
+
+		// Use the compiled cache if it was made from this version of the file, otherwise parse the
+		// YAML and compile the cache for next time.
+		std::string cacheFile = fs::path(configFile).replace_extension(".cache").string();
+
+		if (ZoneConnectionsCache_Read(cacheFile, source, outData))
+		{
+			result.fromCache = true;
+		}
+		else
+		{
+			ParseZoneConnections(contents, YAML::Load(contents), outData);
+
+			result.cacheWrite = std::async(std::launch::async,
+				[cacheFile, source, data = outData]()
+			{
+				return ZoneConnectionsCache_Write(cacheFile, source, data);
+			});
+		}
+
+		SetFileState(result.mainFile, modifiedTime, contents, outData);
 	}
 	catch (const YAML::ParserException& ex)
 	{
 		// failed to parse, notify and return
 		SPDLOG_ERROR("Failed to parse YAML in {}: {}", configFile, ex.what());
-		return;
+		return false;
 	}
 	catch (const YAML::BadFile&)
 	{
-		// if we can't read the file, then try to write it with an empty config
-		return;
+		return false;
 	}
 
-	LoadOverride({});
+	return true;
 }
 
-void ZoneConnections::ReloadFindableLocations(std::string_view customFile)
+// Reads and parses the override file. A missing override file is the same as an empty one.
+static bool ReadZoneConnectionsOverride(const std::string& configFile, ZoneConnectionsData& outData,
+	LoadedZoneConnections& result)
 {
-	SPDLOG_INFO("Reloading zone connections");
+	if (!fs::exists(configFile))
+		return true;
 
-	Load(customFile);
-	LoadFindableLocations();
+	try
+	{
+		int64_t modifiedTime = GetModifiedTime(configFile);
+		std::string contents = ReadFileContents(configFile);
+
+		ParseZoneConnections(contents, YAML::Load(contents), outData);
+		SetFileState(result.overrideFile, modifiedTime, contents, outData);
+	}
+	catch (const YAML::ParserException& ex)
+	{
+		// failed to parse, notify and return
+		SPDLOG_ERROR("Failed to parse YAML in {}: {}", configFile, ex.what());
+		return false;
+	}
+	catch (const YAML::BadFile&)
+	{
+		// if we can't read the file, then ignore
+		return true;
+	}
+
+	return true;
 }
 
-void ZoneConnections::LoadFindableLocations()
+// Zone id of a short name from the zone connection files, or 0 if there is no such zone.
+static EQZoneIndex ResolveZoneName(const std::string& name)
 {
-	if (!pWorldData)
-		return;
-	m_zoneDataLoaded = true;
+	EQZoneIndex zoneId = GetZoneID(name.c_str());
+	if (zoneId > 0)
+		return zoneId;
 
-	FindWindow_Reset();
+	SPDLOG_WARN("Unknown zone in zone connections: {}", name);
+	return 0;
+}
 
-	FindableLocationsMap locationMap;
+static std::string GetZoneNameKey(std::string name)
+{
+	MakeLower(name);
+	return name;
+}
 
-	LoadFindableLocations_Internal(m_zoneConnectionsConfig);
-	LoadFindableLocations_Internal(m_zoneConnectionsOverrideConfig);
+// Builds a zone's data from its parsed locations, moving "remove" entries to the removed
+// connections list.
+static void SetZoneData(EZZoneData& zoneData, EQZoneIndex zoneId, std::vector<ParsedFindableLocation>&& locations)
+{
+	zoneData.zoneId = zoneId;
+	zoneData.findableLocations = std::move(locations);
 
-	FindWindow_LoadZoneConnections();
+	zoneData.removedConnections.clear();
+	zoneData.findableLocations.erase(
+		std::remove_if(zoneData.findableLocations.begin(), zoneData.findableLocations.end(),
+			[&](const ParsedFindableLocation& pfl)
+	{
+		if (pfl.remove)
+		{
+			if (pfl.zoneId != 0)
+				zoneData.removedConnections.push_back(pfl.zoneId);
+
+			return true;
+		}
+
+		return false;
+	}), zoneData.findableLocations.end());
 }
 
-void ZoneConnections::LoadFindableLocations_Internal(YAML::Node zoneConnectionsConfig)
+// Merges one parsed file into the loaded zone connections. Anything in a later file replaces
+// what an earlier file had for the same zone, group or teleport.
+static void MergeZoneConnections(ZoneConnectionsData& data, LoadedZoneConnections& result)
 {
-	try
+	// move the findable locations into place.
+	for (auto& [name, locations] : data.findLocations)
 	{
-		ParsedFindableLocationsMap newLocations;
+		EQZoneIndex zoneId = ResolveZoneName(name);
+		if (zoneId == 0)
+			continue;
 
-		// Load objects from the FindLocations block
-		YAML::Node addFindLocations = zoneConnectionsConfig["FindLocations"];
-		if (addFindLocations.IsMap())
+		if ((size_t)zoneId >= result.zoneData.size())
+			result.zoneData.resize(zoneId + 1);
+
+		SetZoneData(result.zoneData[zoneId], zoneId, std::move(locations));
+		result.zoneIds[GetZoneNameKey(name)] = zoneId;
+	}
+
+	for (const auto& [groupName, zoneNames] : data.zoneGroups)
+	{
+		std::vector<EQZoneIndex>& zones = result.zoneGroups[groupName];
+		zones.clear();
+
+		for (const std::string& zoneName : zoneNames)
 		{
-			newLocations = addFindLocations.as<ParsedFindableLocationsMap>();
+			EQZoneIndex zoneId = GetZoneID(zoneName.c_str());
+
+			if (zoneId > 0)
+				zones.push_back(zoneId);
+			else
+				SPDLOG_WARN("Unknown zone in zone group {}: {}", groupName, zoneName);
 		}
+	}
+
+	for (ParsedTeleport& teleport : data.teleports)
+	{
+		auto iter = std::find_if(result.teleports.begin(), result.teleports.end(),
+			[&](const ParsedTeleport& other) { return !teleport.name.empty() && ci_equals(other.name, teleport.name); });
+
+		if (iter != result.teleports.end())
+			*iter = std::move(teleport);
+		else
+			result.teleports.push_back(std::move(teleport));
+	}
+}
+
+// Runs on a worker thread. Only reads zone data, to resolve zone names, and leaves everything
+// else to ZoneConnections::Pulse on the game thread. Returns null if the load failed, in which
+// case the zone connections that are already loaded are kept.
+static std::unique_ptr<LoadedZoneConnections> LoadZoneConnections(const std::string& configFile,
+	const std::string& overrideFile)
+{
+	auto startTime = std::chrono::steady_clock::now();
+	auto result = std::make_unique<LoadedZoneConnections>();
+
+	ZoneConnectionsData zoneConnections;
+	if (!ReadZoneConnections(configFile, zoneConnections, *result))
+		return nullptr;
+
+	ZoneConnectionsData overrides;
+	if (!ReadZoneConnectionsOverride(overrideFile, overrides, *result))
+		return nullptr;
+
+	MergeZoneConnections(zoneConnections, *result);
+	MergeZoneConnections(overrides, *result);
+
+	result->loadTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	return result;
+}
+
+// One of the zone connection files, as seen by an update.
+struct ZoneConnectionsFileUpdate
+{
+	std::string fileName;
+	ZoneConnectionsFileState state;
+	bool read = false;
+	std::string contents;
+	YAML::Node config;
+	ZoneConnectionsData data;                             // only the zones that changed
+	std::vector<std::string> changedZones;
+};
+
+static void ReadFileForUpdate(ZoneConnectionsFileUpdate& file)
+{
+	file.read = true;
+	file.state.modifiedTime = GetModifiedTime(file.fileName);
+
+	std::error_code ec;
+	if (fs::exists(file.fileName, ec))
+		file.contents = ReadFileContents(file.fileName);
+	file.config = YAML::Load(file.contents);
+}
+
+// Runs on a worker thread. Re-reads the files that were edited and decodes only the zones whose
+// entries changed. Anything outside of FindLocations changing asks for a full reload instead.
+static std::unique_ptr<ZoneConnectionsUpdate> UpdateZoneConnections(const std::string& configFile,
+	const std::string& overrideFile, const ZoneConnectionsFileState& mainState,
+	const ZoneConnectionsFileState& overrideState)
+{
+	auto startTime = std::chrono::steady_clock::now();
+	auto update = std::make_unique<ZoneConnectionsUpdate>();
+
+	ZoneConnectionsFileUpdate mainFile{ configFile, mainState };
+	ZoneConnectionsFileUpdate overrides{ overrideFile, overrideState };
+
+	// The file states are returned even when asking for a full reload, so that a file that
+	// fails to load isn't retried until it is saved again.
+	auto finish = [&](bool fullReload)
+	{
+		update->fullReload = fullReload;
+		update->mainFile = std::move(mainFile.state);
+		update->overrideFile = std::move(overrides.state);
+		update->updateTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+		return std::move(update);
+	};
+
+	for (ZoneConnectionsFileUpdate* file : { &mainFile, &overrides })
+	{
+		if (IsFileUnchanged(file->fileName, file->state))
+			continue;
+
+		ZoneConnectionsFileState previous = file->state;
 
-		// move the findable locations into place.
-		for (auto& [name, locations] : newLocations)
+		try
 		{
-			EZZoneData& data = m_findableLocations[name];
+			ReadFileForUpdate(*file);
+		}
+		catch (const YAML::ParserException& ex)
+		{
+			// Keep what is loaded, and try again when the file is next saved.
+			SPDLOG_ERROR("Failed to parse YAML in {}: {}", file->fileName, ex.what());
+			file->state.size = file->contents.size();
+			file->read = false;
+			continue;
+		}
+		catch (const YAML::BadFile&)
+		{
+			return finish(true);
+		}
 
-			data.zoneId = GetZoneID(name.c_str());
-			data.findableLocations = std::move(locations);
+		ParseZoneConnections(file->contents, file->config, file->data, &previous.zoneHashes);
+		SetFileState(file->state, file->state.modifiedTime, file->contents, file->data);
 
-			// move any "remove" entries to the removed connections list
-			data.removedConnections.clear();
-			data.findableLocations.erase(
-				std::remove_if(data.findableLocations.begin(), data.findableLocations.end(),
-					[&](const ParsedFindableLocation& pfl)
-			{
-				if (pfl.remove)
-				{
-					if (pfl.zoneId != 0)
-						data.removedConnections.push_back(pfl.zoneId);
+		if (file->state.sectionsHash != previous.sectionsHash || (file == &mainFile && file->contents.empty()))
+			return finish(true);
 
-					return true;
-				}
+		for (const auto& [name, hash] : file->state.zoneHashes)
+		{
+			auto iter = previous.zoneHashes.find(name);
+			if (iter == previous.zoneHashes.end() || iter->second != hash)
+				file->changedZones.push_back(name);
+		}
+		for (const auto& [name, hash] : previous.zoneHashes)
+		{
+			if (file->state.zoneHashes.count(name) == 0)
+				file->changedZones.push_back(name);
+		}
+	}
 
-				return false;
-			}), data.findableLocations.end());
+	std::set<std::string, ci_less> changedZones;
+	changedZones.insert(mainFile.changedZones.begin(), mainFile.changedZones.end());
+	changedZones.insert(overrides.changedZones.begin(), overrides.changedZones.end());
 
-			// Load any removed zones into the zone guide.
-			if (pZoneGuideWnd && !data.removedConnections.empty())
+	for (const std::string& name : changedZones)
+	{
+		EQZoneIndex zoneId = ResolveZoneName(name);
+		if (zoneId == 0)
+			continue;
+
+		// Keep what was loaded for a zone whose entry doesn't parse until it is fixed, rather than
+		// taking it as removed.
+		if (mainFile.data.failedZones.count(name) != 0 || overrides.data.failedZones.count(name) != 0)
+			continue;
+
+		// The override file replaces a zone's whole entry, so the main file only counts for zones
+		// that the override file doesn't have.
+		bool inOverrides = overrides.state.zoneHashes.count(name) != 0;
+		ZoneConnectionsFileUpdate* source = inOverrides ? &overrides
+			: mainFile.state.zoneHashes.count(name) != 0 ? &mainFile : nullptr;
+
+		if (source == nullptr)
+		{
+			update->zones.push_back({ name, zoneId, std::nullopt });
+			continue;
+		}
+
+		auto iter = source->data.findLocations.find(name);
+		if (iter != source->data.findLocations.end())
+		{
+			EZZoneData zoneData;
+			SetZoneData(zoneData, zoneId, std::move(iter->second));
+			update->zones.push_back({ name, zoneId, std::move(zoneData) });
+			continue;
+		}
+
+		// An unchanged override entry still hides whatever changed in the main file.
+		if (inOverrides)
+			continue;
+
+		// The override entry that hid this zone is gone, so go back to the main file's entry.
+		try
+		{
+			if (!mainFile.read)
+				ReadFileForUpdate(mainFile);
+
+			const YAML::Node& config = mainFile.config;
+			for (const auto& zoneNode : config["FindLocations"])
 			{
-				ZoneGuideZone* zoneGuideZone = ZoneGuideManagerClient::Instance().GetZone(data.zoneId);
-				if (zoneGuideZone)
+				if (ci_equals(zoneNode.first.as<std::string>(), name))
 				{
-					for (int destZoneId : data.removedConnections)
+					try
 					{
-						for (ZoneGuideConnection& connection : zoneGuideZone->zoneConnections)
-						{
-							if (connection.destZoneId == destZoneId)
-								connection.disabled = true;
-						}
+						EZZoneData zoneData;
+						SetZoneData(zoneData, zoneId, zoneNode.second.as<std::vector<ParsedFindableLocation>>());
+						update->zones.push_back({ name, zoneId, std::move(zoneData) });
 					}
+					catch (const YAML::Exception& ex)
+					{
+						// keep what is loaded, like any other zone that fails to parse
+						SPDLOG_ERROR("Failed to load zone connections for {}: {}", name, ex.what());
+					}
+					break;
 				}
 			}
 		}
+		catch (const YAML::Exception&)
+		{
+			return finish(true);
+		}
 	}
-	catch (const YAML::Exception& ex)
+
+	return finish(false);
+}
+
+// Disables the zone guide connections that a zone's entry removes, or enables them again.
+static void SetRemovedConnectionsDisabled(const EZZoneData& zoneData, bool disabled)
+{
+	if (!pZoneGuideWnd || zoneData.removedConnections.empty())
+		return;
+
+	ZoneGuideZone* zoneGuideZone = ZoneGuideManagerClient::Instance().GetZone(zoneData.zoneId);
+	if (!zoneGuideZone)
+		return;
+
+	for (int destZoneId : zoneData.removedConnections)
 	{
-		// failed to parse, notify and return
-		SPDLOG_ERROR("Failed to load zone connections: {}", ex.what());
+		for (ZoneGuideConnection& connection : zoneGuideZone->zoneConnections)
+		{
+			if (connection.destZoneId == destZoneId)
+				connection.disabled = disabled;
+		}
 	}
 }
 
+ZoneConnections::ZoneConnections(const std::string& easyfindDirectory)
+	: m_easyfindDir(easyfindDirectory)
+{
+	std::error_code ec;
+	if (!fs::is_directory(m_easyfindDir, ec))
+	{
+		fs::create_directories(m_easyfindDir, ec);
+	}
+
+	m_overrideFile = (fs::path(m_easyfindDir) / "ZoneConnections_Override.yaml").string();
+
+	Load();
+}
+
+ZoneConnections::~ZoneConnections()
+{
+	// don't leave a load running, or a cache half written
+	if (m_pendingLoad.valid())
+		m_pendingLoad.wait();
+	if (m_pendingUpdate.valid())
+		m_pendingUpdate.wait();
+	for (std::future<bool>& cacheWrite : m_cacheWrites)
+		cacheWrite.wait();
+}
+
+void ZoneConnections::Load(std::string_view customFile)
+{
+	if (customFile.empty())
+		customFile = "ZoneConnections.yaml";
+
+	// Loading starts from Pulse, once zone data is available to resolve zone names.
+	m_loadFile = (fs::path(m_easyfindDir) / customFile).string();
+	m_loadRequested = true;
+}
+
+void ZoneConnections::ReloadFindableLocations(std::string_view customFile)
+{
+	SPDLOG_INFO("Reloading zone connections");
+
+	Load(customFile);
+}
+
+void ZoneConnections::StartLoad()
+{
+	m_loadRequested = false;
+	m_cacheFile = fs::path(m_loadFile).replace_extension(".cache").string();
+
+	m_pendingLoad = std::async(std::launch::async,
+		[configFile = m_loadFile, overrideFile = m_overrideFile]() { return LoadZoneConnections(configFile, overrideFile); });
+}
+
+void ZoneConnections::AdoptLoad(LoadedZoneConnections& loaded)
+{
+	// The find window points into the old locations, so let go of them first.
+	FindWindow_Reset();
+
+	m_zoneData = std::move(loaded.zoneData);
+	m_zoneIds = std::move(loaded.zoneIds);
+	m_zoneGroups = std::move(loaded.zoneGroups);
+	m_teleports = std::move(loaded.teleports);
+	m_loadFileState = std::move(loaded.mainFile);
+	m_overrideFileState = std::move(loaded.overrideFile);
+	m_loadedFromCache = loaded.fromCache;
+	m_loadTime = loaded.loadTime;
+	m_zoneConnectionsLoaded = true;
+
+	if (loaded.cacheWrite.valid())
+		m_cacheWrites.push_back(std::move(loaded.cacheWrite));
+
+	SPDLOG_DEBUG("Loaded zone connections from {} in {:.2f} ms", m_loadedFromCache ? "cache" : "YAML", m_loadTime);
+
+	// Load any removed zones into the zone guide.
+	for (const EZZoneData& zoneData : m_zoneData)
+		SetRemovedConnectionsDisabled(zoneData, true);
+
+	m_achievementsResolved = false;
+	if (GetGameState() == GAMESTATE_INGAME)
+		ResolveAchievements();
+
+	ZonePath_InvalidateGraph();
+	FindWindow_LoadZoneConnections();
+}
+
+void ZoneConnections::StartUpdate()
+{
+	m_pendingUpdate = std::async(std::launch::async,
+		[configFile = m_loadFile, overrideFile = m_overrideFile, mainState = m_loadFileState, overrideState = m_overrideFileState]()
+	{
+		return UpdateZoneConnections(configFile, overrideFile, mainState, overrideState);
+	});
+}
+
+void ZoneConnections::AdoptUpdate(ZoneConnectionsUpdate& update)
+{
+	m_loadFileState = std::move(update.mainFile);
+	m_overrideFileState = std::move(update.overrideFile);
+
+	if (update.fullReload)
+	{
+		SPDLOG_INFO("Reloading zone connections");
+		m_loadRequested = true;
+		return;
+	}
+
+	if (update.zones.empty())
+		return;
+
+	// The find window only has locations for the current zone, so it can be left alone otherwise.
+	EQZoneInfo* currentZone = pLocalPC && pWorldData ? pWorldData->GetZone(pLocalPC->currentZoneId) : nullptr;
+	bool currentZoneChanged = currentZone && std::any_of(update.zones.begin(), update.zones.end(),
+		[&](const ZoneConnectionsUpdate::Zone& zone) { return zone.zoneId == currentZone->Id; });
+
+	if (currentZoneChanged)
+		FindWindow_Reset();
+
+	std::string zoneNames;
+	for (ZoneConnectionsUpdate::Zone& zone : update.zones)
+	{
+		// Growing the list moves the zone data, but not the locations that the find window points to.
+		if ((size_t)zone.zoneId >= m_zoneData.size())
+			m_zoneData.resize(zone.zoneId + 1);
+
+		EZZoneData& zoneData = m_zoneData[zone.zoneId];
+		SetRemovedConnectionsDisabled(zoneData, false);
+
+		if (zone.data)
+		{
+			zoneData = std::move(*zone.data);
+			SetRemovedConnectionsDisabled(zoneData, true);
+			m_zoneIds[GetZoneNameKey(zone.shortName)] = zone.zoneId;
+		}
+		else
+		{
+			zoneData = {};
+			m_zoneIds.erase(GetZoneNameKey(zone.shortName));
+		}
+
+		if (!zoneNames.empty())
+			zoneNames += ", ";
+		zoneNames += zone.shortName;
+	}
+
+	SPDLOG_INFO("Updated zone connections for \ag{}\ax in {:.2f} ms", zoneNames, update.updateTime);
+
+	m_achievementsResolved = false;
+	if (GetGameState() == GAMESTATE_INGAME)
+		ResolveAchievements();
+
+	ZonePath_InvalidateGraph();
+
+	if (currentZoneChanged)
+		FindWindow_LoadZoneConnections();
+}
+
+const std::vector<EQZoneIndex>* ZoneConnections::GetZoneGroup(std::string_view name) const
+{
+	auto iter = m_zoneGroups.find(name);
+	if (iter == m_zoneGroups.end())
+		return nullptr;
+
+	return &iter->second;
+}
+
+const ParsedTeleport* ZoneConnections::FindTeleport(std::string_view name) const
+{
+	auto iter = std::find_if(m_teleports.begin(), m_teleports.end(),
+		[&](const ParsedTeleport& teleport) { return ci_equals(teleport.name, name); });
+
+	return iter != m_teleports.end() ? &*iter : nullptr;
+}
+
+void ZoneConnections::ResolveAchievements()
+{
+	// Achievement names are only looked up once, so that checking requirements is a lookup by id.
+	int unresolved = 0;
+
+	for (EZZoneData& zoneData : m_zoneData)
+	{
+		for (ParsedFindableLocation& location : zoneData.findableLocations)
+		{
+			if (!location.ResolveAchievement())
+			{
+				SPDLOG_WARN("Unknown achievement in zone connections for {}: {}", GetShortZone(zoneData.zoneId), location.requiredAchievementName);
+				++unresolved;
+			}
+		}
+	}
+
+	if (unresolved > 0)
+		SPDLOG_DEBUG("{} achievement requirements could not be resolved and will be checked by name", unresolved);
+
+	m_achievementsResolved = true;
+}
+
 void ZoneConnections::CreateFindableLocations(FindableLocations& findableLocations, std::string_view shortName)
 {
-	auto iter = m_findableLocations.find(shortName);
-	if (iter == m_findableLocations.end())
+	auto iter = m_zoneIds.find(GetZoneNameKey(std::string(shortName)));
+	if (iter == m_zoneIds.end())
 		return;
 
-	std::vector<ParsedFindableLocation>& parsedLocations = iter->second.findableLocations;
+	const std::vector<ParsedFindableLocation>& parsedLocations = GetZoneData(iter->second).findableLocations;
 
 	findableLocations.reserve(parsedLocations.size());
 
@@ -463,16 +1197,13 @@ void ZoneConnections::CreateFindableLocations(FindableLocations& findableLocatio
 
 const EZZoneData& ZoneConnections::GetZoneData(EQZoneIndex zoneId) const
 {
-	const char* zoneName = GetShortZone(zoneId);
-
-	auto iter = m_findableLocations.find(zoneName);
-	if (iter == m_findableLocations.end())
+	if (zoneId <= 0 || (size_t)zoneId >= m_zoneData.size())
 	{
 		static EZZoneData empty;
 		return empty;
 	}
 
-	return iter->second;
+	return m_zoneData[zoneId];
 }
 
 bool ZoneConnections::MigrateIniData()
@@ -639,20 +1370,56 @@ bool ZoneConnections::MigrateIniData()
 
 void ZoneConnections::Pulse()
 {
-	if (!m_zoneDataLoaded)
+	for (auto iter = m_cacheWrites.begin(); iter != m_cacheWrites.end();)
 	{
-		if (pWorldData)
+		if (iter->wait_for(std::chrono::seconds(0)) != std::future_status::ready)
 		{
-			m_zoneDataLoaded = true;
-			LoadFindableLocations();
+			++iter;
+			continue;
 		}
+
+		if (!iter->get())
+			SPDLOG_WARN("Failed to write zone connections cache: {}", m_cacheFile);
+		iter = m_cacheWrites.erase(iter);
 	}
+
+	if (m_pendingLoad.valid()
+		&& m_pendingLoad.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+	{
+		if (std::unique_ptr<LoadedZoneConnections> loaded = m_pendingLoad.get())
+			AdoptLoad(*loaded);
+	}
+
+	if (m_pendingUpdate.valid()
+		&& m_pendingUpdate.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+	{
+		if (std::unique_ptr<ZoneConnectionsUpdate> update = m_pendingUpdate.get())
+			AdoptUpdate(*update);
+	}
+
+	if (m_loadRequested && pWorldData && !m_pendingLoad.valid() && !m_pendingUpdate.valid())
+		StartLoad();
+
+	// Pick up edits to the zone connection files without a full reload.
+	auto now = std::chrono::steady_clock::now();
+	if (m_zoneConnectionsLoaded && !m_loadRequested && !m_pendingLoad.valid() && !m_pendingUpdate.valid()
+		&& now >= m_nextFileCheck)
+	{
+		m_nextFileCheck = now + std::chrono::seconds(1);
+
+		if (!IsFileUnchanged(m_loadFile, m_loadFileState) || !IsFileUnchanged(m_overrideFile, m_overrideFileState))
+			StartUpdate();
+	}
+
 	if (GetGameState() != GAMESTATE_INGAME)
 	{
 		m_transferTypesLoaded = false;
 		return;
 	}
 
+	if (!m_achievementsResolved)
+		ResolveAchievements();
+
 	if (!m_transferTypesLoaded
 		&& ZoneGuideManagerClient::Instance().zoneGuideDataSet)
 	{
@@ -8,12 +8,17 @@
 #include <yaml-cpp/yaml.h>
 #pragma warning( pop )
 
+#include <chrono>
+#include <future>
+#include <set>
 #include <string>
+#include <unordered_map>
 
 // Information parsed from YAML
 struct ParsedTranslocatorDestination
 {
 	std::string keyword;
+	std::string targetZone;           // zone short name or id, as written in the file
 	EQZoneIndex zoneId = 0;           // numeric zone id
 	int zoneIdentifier = 0;
 };
@@ -24,6 +29,7 @@ struct ParsedFindableLocation
 	LocationType type;                // interpreted type
 	std::optional<glm::vec3> location;
 	std::string name;
+	std::string targetZone;           // zone short name or id, as written in the file
 	EQZoneIndex zoneId = 0;           // numeric zone id
 	int zoneIdentifier = 0;
 	int switchId = -1;                // switch num, or -1 if not set
@@ -34,6 +40,8 @@ struct ParsedFindableLocation
 	bool remove = false;
 	std::vector<ParsedTranslocatorDestination> translocatorDestinations;
 
+	int cost = -1;                    // travel cost override, or -1 to derive it from the type
+
 	EQExpansionOwned requiredExpansions = (EQExpansionOwned)0;
 	int requiredAchievement = 0;
 	std::string requiredAchievementName;
@@ -41,14 +49,75 @@ struct ParsedFindableLocation
 	bool IsZoneConnection() const;
 
 	bool CheckRequirements() const; // returns true if requirements are met.
+
+	// Looks up requiredAchievementName so that requirements can be checked by id.
+	bool ResolveAchievement();
 };
+// Checks a findable location's requirements, for callers that copied them out of the location.
+bool CheckFindableLocationRequirements(EQExpansionOwned requiredExpansions, int requiredAchievement,
+	const std::string& requiredAchievementName);
+
+// Resolves a targetZone from the zone connection files, which is either a zone short name or a zone id.
+EQZoneIndex ResolveTargetZoneName(const std::string& targetZone);
+
 using ParsedFindableLocationsMap = std::map<std::string, std::vector<ParsedFindableLocation>, ci_less>;
 
+// A teleport that can be used from any zone, e.g. gate, an AA or a clicky item. Spell teleports
+// (druid and wizard ports, translocate) are cast by whoever in the group has the spell.
+struct ParsedTeleport
+{
+	std::string name;
+	std::string command;              // command that performs the teleport
+	std::string spell;                // spell to cast instead of the command
+	std::vector<std::string> classes; // class short names that can cast the spell
+	int level = 0;                    // level required to cast the spell
+	std::string targetZone;           // zone short name, "bind", or a macro expression that yields a short name
+	std::string condition;            // macro expression that must be true to use it, or empty
+	int castTime = 0;                 // seconds
+	int cooldown = 0;                 // seconds
+	int cost = -1;                    // travel cost override, or -1 to derive it from the cast time
+
+	// runtime state
+	mutable std::chrono::steady_clock::time_point cooldownEnd;
+	mutable std::string caster;       // group member that will cast the spell, found by IsReady
+
+	EQZoneIndex ResolveTargetZone() const;
+	bool IsReady() const;             // returns true if off cooldown and the condition is met.
+	void Use() const;
+
+private:
+	bool FindCaster() const;
+};
+
+using ZoneHashesMap = std::map<std::string, uint64_t, ci_less>;
+
+// Everything read from one zone connections file, before it is merged into the loaded locations.
+struct ZoneConnectionsData
+{
+	ParsedFindableLocationsMap findLocations;
+	std::vector<std::pair<std::string, std::vector<std::string>>> zoneGroups; // zone short names by group
+	std::vector<ParsedTeleport> teleports;
+
+	ZoneHashesMap zoneHashes;                             // hash of each zone's entry in FindLocations
+	uint64_t sectionsHash = 0;                            // hash of everything outside of FindLocations
+	std::set<std::string, ci_less> failedZones;           // entries in FindLocations that failed to parse
+};
+
+// What was read from a zone connections file, to tell what changed when it is edited.
+struct ZoneConnectionsFileState
+{
+	int64_t modifiedTime = 0;
+	uint64_t size = 0;
+	uint64_t contentHash = 0;
+	ZoneHashesMap zoneHashes;
+	uint64_t sectionsHash = 0;
+};
+
 //----------------------------------------------------------------------------
 
 struct EZZoneData
 {
-	EQZoneIndex zoneId;
+	EQZoneIndex zoneId = 0;
 
 	// our custom list of findable locations
 	std::vector<ParsedFindableLocation> findableLocations;
@@ -57,7 +126,45 @@ struct EZZoneData
 	std::vector<int> removedConnections;
 };
 
-using FindableLocationsMap = std::map<std::string, EZZoneData, ci_less>;
+// Zone data indexed by zone id. Zones without findable locations have a zone id of 0.
+using ZoneDataList = std::vector<EZZoneData>;
+
+// Zone ids by lower case short name, for looking zones up by name while loading.
+using ZoneIdsMap = std::unordered_map<std::string, EQZoneIndex>;
+
+// Named sets of zones, e.g. all zones with a bank, that can be used as a travel destination.
+using ZoneGroupsMap = std::map<std::string, std::vector<EQZoneIndex>, ci_less>;
+
+// Zone connections loaded on a worker thread, waiting to be adopted on the game thread.
+struct LoadedZoneConnections
+{
+	ZoneDataList zoneData;
+	ZoneIdsMap zoneIds;
+	ZoneGroupsMap zoneGroups;
+	std::vector<ParsedTeleport> teleports;
+	ZoneConnectionsFileState mainFile;
+	ZoneConnectionsFileState overrideFile;
+	bool fromCache = false;
+	double loadTime = 0;                                  // milliseconds
+	std::future<bool> cacheWrite;                         // cache being compiled from the YAML, if any
+};
+
+// Zones whose entries were edited since the files were loaded, waiting to be adopted on the game thread.
+struct ZoneConnectionsUpdate
+{
+	struct Zone
+	{
+		std::string shortName;
+		EQZoneIndex zoneId = 0;
+		std::optional<EZZoneData> data;                   // new data, or nullopt if removed
+	};
+
+	std::vector<Zone> zones;
+	ZoneConnectionsFileState mainFile;
+	ZoneConnectionsFileState overrideFile;
+	bool fullReload = false;                              // something other than FindLocations changed
+	double updateTime = 0;                                // milliseconds
+};
 
 class ZoneConnections
 {
@@ -67,9 +174,10 @@ public:
 
 	const std::string& GetConfigDir() const { return m_easyfindDir; }
 
+	// Loads zone connections on a worker thread. They are adopted by Pulse when ready, and until
+	// then the previously loaded zone connections stay in use. Once loaded, the files are watched
+	// and zones that are edited are reloaded on their own.
 	void Load(std::string_view customFile = {});
-	void LoadOverride(std::string_view customFile);
-	void LoadFindableLocations();
 
 	void ReloadFindableLocations(std::string_view customFile = {});
 
@@ -78,21 +186,57 @@ public:
 	bool MigrateIniData();
 
 	const EZZoneData& GetZoneData(EQZoneIndex zoneId) const;
+	const ZoneDataList& GetAllZoneData() const { return m_zoneData; }
+
+	// Returns the zones in the named group, or null if there is no such group.
+	const std::vector<EQZoneIndex>* GetZoneGroup(std::string_view name) const;
+	const ZoneGroupsMap& GetZoneGroups() const { return m_zoneGroups; }
+
+	const std::vector<ParsedTeleport>& GetTeleports() const { return m_teleports; }
+
+	// Returns the teleport with the given name, or null if there isn't one.
+	const ParsedTeleport* FindTeleport(std::string_view name) const;
+
+	// Hash of the contents of the loaded zone connection files.
+	uint64_t GetContentHash() const { return m_loadFileState.contentHash ^ (m_overrideFileState.contentHash * 31); }
+
+	// How ZoneConnections.yaml was last loaded, for diagnostics.
+	bool IsLoadedFromCache() const { return m_loadedFromCache; }
+	double GetLoadTime() const { return m_loadTime; }      // milliseconds
 
 	void Pulse();
 
 private:
 	std::string m_easyfindDir;
-	YAML::Node m_zoneConnectionsConfig;
-	YAML::Node m_zoneConnectionsOverrideConfig;
+	std::string m_loadFile;
+	std::string m_overrideFile;
+	ZoneConnectionsFileState m_loadFileState;
+	ZoneConnectionsFileState m_overrideFileState;
+	bool m_zoneConnectionsLoaded = false;
+	bool m_loadRequested = false;
+	std::future<std::unique_ptr<LoadedZoneConnections>> m_pendingLoad;
+	std::future<std::unique_ptr<ZoneConnectionsUpdate>> m_pendingUpdate;
+	std::chrono::steady_clock::time_point m_nextFileCheck;
+
+	std::string m_cacheFile;
+	std::vector<std::future<bool>> m_cacheWrites;          // drained by Pulse, so that nothing waits on them
+	bool m_loadedFromCache = false;
+	double m_loadTime = 0;
 
 	bool m_transferTypesLoaded = false;
-	bool m_zoneDataLoaded = false;
+	bool m_achievementsResolved = false;
 
 	// Loaded findable locations
-	FindableLocationsMap m_findableLocations;
-
-	void LoadFindableLocations_Internal(YAML::Node zoneConnectionsConfig);
+	ZoneDataList m_zoneData;
+	ZoneIdsMap m_zoneIds;
+	ZoneGroupsMap m_zoneGroups;
+	std::vector<ParsedTeleport> m_teleports;
+
+	void StartLoad();
+	void AdoptLoad(LoadedZoneConnections& loaded);
+	void StartUpdate();
+	void AdoptUpdate(ZoneConnectionsUpdate& update);
+	void ResolveAchievements();
 };
 
 extern ZoneConnections* g_zoneConnections;
@@ -0,0 +1,516 @@
+
+#include "EasyFind.h"
+#include "EasyFindZoneConnectionsCache.h"
+
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+// The cache is a header followed by fixed size record arrays in the order of the counts in the
+// header, and then a single blob holding every string. Records refer to strings and to each
+// other by offset and index, so the file is mapped and read in place, with no text to parse. The
+// records are still copied out into the parsed structures, which is where the time goes. Target
+// zones are kept as written and resolved when the cache is read, since zone ids can change with
+// the client.
+static constexpr uint32_t CacheMagic = 0x4346455a;      // "ZEFC"
+static constexpr uint32_t CacheVersion = 3;
+
+struct CacheString
+{
+	uint32_t offset;
+	uint32_t length;
+};
+
+struct CacheHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t sourceSize;
+	int64_t sourceModifiedTime;
+	uint64_t sourceHash;
+	uint64_t sectionsHash;
+	uint32_t zoneCount;
+	uint32_t locationCount;
+	uint32_t destinationCount;
+	uint32_t groupCount;
+	uint32_t groupZoneCount;
+	uint32_t teleportCount;
+	uint32_t teleportClassCount;
+	uint32_t stringSize;
+};
+
+struct CacheZone
+{
+	CacheString shortName;
+	uint32_t firstLocation;
+	uint32_t locationCount;
+	uint64_t hash;                                        // of the zone's text in the YAML
+};
+
+struct CacheLocation
+{
+	CacheString typeString;
+	CacheString name;
+	CacheString switchName;
+	CacheString luaScript;
+	CacheString luaScriptFile;
+	CacheString requiredAchievementName;
+	CacheString targetZone;
+	uint64_t requiredExpansions;
+	float location[3];
+	int32_t zoneIdentifier;
+	int32_t switchId;
+	int32_t cost;
+	int32_t requiredAchievement;
+	uint32_t firstDestination;
+	uint32_t destinationCount;
+	uint8_t type;
+	uint8_t hasLocation;
+	uint8_t replace;
+	uint8_t remove;
+};
+
+struct CacheDestination
+{
+	CacheString keyword;
+	CacheString targetZone;
+	int32_t zoneIdentifier;
+};
+
+struct CacheZoneGroup
+{
+	CacheString name;
+	uint32_t firstZone;                                   // into the group zone names
+	uint32_t zoneCount;
+};
+
+struct CacheTeleport
+{
+	CacheString name;
+	CacheString command;
+	CacheString spell;
+	CacheString targetZone;
+	CacheString condition;
+	uint32_t firstClass;                                  // into the teleport class names
+	uint32_t classCount;
+	int32_t level;
+	int32_t castTime;
+	int32_t cooldown;
+	int32_t cost;
+};
+
+// Where each section starts. Sections are 8 byte aligned so that records can be read in place.
+struct CacheLayout
+{
+	uint64_t zones;
+	uint64_t locations;
+	uint64_t destinations;
+	uint64_t groups;
+	uint64_t groupZones;
+	uint64_t teleports;
+	uint64_t teleportClasses;
+	uint64_t strings;
+	uint64_t size;
+};
+
+static CacheLayout GetCacheLayout(const CacheHeader& header)
+{
+	uint64_t offset = sizeof(CacheHeader);
+
+	auto section = [&](uint64_t count, uint64_t recordSize)
+	{
+		uint64_t start = (offset + 7) & ~uint64_t(7);
+		offset = start + count * recordSize;
+		return start;
+	};
+
+	CacheLayout layout;
+	layout.zones = section(header.zoneCount, sizeof(CacheZone));
+	layout.locations = section(header.locationCount, sizeof(CacheLocation));
+	layout.destinations = section(header.destinationCount, sizeof(CacheDestination));
+	layout.groups = section(header.groupCount, sizeof(CacheZoneGroup));
+	layout.groupZones = section(header.groupZoneCount, sizeof(CacheString));
+	layout.teleports = section(header.teleportCount, sizeof(CacheTeleport));
+	layout.teleportClasses = section(header.teleportClassCount, sizeof(CacheString));
+	layout.strings = section(header.stringSize, 1);
+	layout.size = offset;
+	return layout;
+}
+
+// Read only view of a whole file.
+class MappedFile
+{
+public:
+	explicit MappedFile(const std::string& fileName)
+	{
+		m_file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (m_file == INVALID_HANDLE_VALUE)
+			return;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+			return;
+
+		m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mapping == nullptr)
+			return;
+
+		m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+		if (m_data != nullptr)
+			m_size = (uint64_t)size.QuadPart;
+	}
+
+	~MappedFile()
+	{
+		if (m_data != nullptr)
+			UnmapViewOfFile(m_data);
+		if (m_mapping != nullptr)
+			CloseHandle(m_mapping);
+		if (m_file != INVALID_HANDLE_VALUE)
+			CloseHandle(m_file);
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const uint8_t* GetData() const { return m_data; }
+	uint64_t GetSize() const { return m_size; }
+
+private:
+	HANDLE m_file = INVALID_HANDLE_VALUE;
+	HANDLE m_mapping = nullptr;
+	const uint8_t* m_data = nullptr;
+	uint64_t m_size = 0;
+};
+
+bool ZoneConnectionsCache_Read(const std::string& cacheFile, const ZoneConnectionsSource& source,
+	ZoneConnectionsData& outData)
+{
+	MappedFile file(cacheFile);
+	if (file.GetSize() < sizeof(CacheHeader))
+		return false;
+
+	const CacheHeader& header = *reinterpret_cast<const CacheHeader*>(file.GetData());
+	if (header.magic != CacheMagic
+		|| header.version != CacheVersion
+		|| header.sourceSize != source.size
+		|| header.sourceModifiedTime != source.modifiedTime
+		|| header.sourceHash != source.contentHash)
+	{
+		return false;
+	}
+
+	CacheLayout layout = GetCacheLayout(header);
+	if (layout.size != file.GetSize())
+		return false;
+
+	const uint8_t* base = file.GetData();
+	auto zones = reinterpret_cast<const CacheZone*>(base + layout.zones);
+	auto locations = reinterpret_cast<const CacheLocation*>(base + layout.locations);
+	auto destinations = reinterpret_cast<const CacheDestination*>(base + layout.destinations);
+	auto groups = reinterpret_cast<const CacheZoneGroup*>(base + layout.groups);
+	auto groupZones = reinterpret_cast<const CacheString*>(base + layout.groupZones);
+	auto teleports = reinterpret_cast<const CacheTeleport*>(base + layout.teleports);
+	auto teleportClasses = reinterpret_cast<const CacheString*>(base + layout.teleportClasses);
+	auto strings = reinterpret_cast<const char*>(base + layout.strings);
+
+	// Every reference is checked, so that a damaged cache falls back to the YAML instead of crashing.
+	bool valid = true;
+
+	auto getString = [&](const CacheString& str)
+	{
+		if ((uint64_t)str.offset + str.length > header.stringSize)
+		{
+			valid = false;
+			return std::string();
+		}
+
+		return std::string(strings + str.offset, str.length);
+	};
+
+	auto inRange = [](uint32_t first, uint32_t count, uint32_t total)
+	{
+		return (uint64_t)first + count <= total;
+	};
+
+	ZoneConnectionsData data;
+
+	for (uint32_t i = 0; i < header.zoneCount; ++i)
+	{
+		const CacheZone& zone = zones[i];
+		if (!inRange(zone.firstLocation, zone.locationCount, header.locationCount))
+			return false;
+
+		std::string shortName = getString(zone.shortName);
+		data.zoneHashes[shortName] = zone.hash;
+
+		std::vector<ParsedFindableLocation>& zoneLocations = data.findLocations[shortName];
+		zoneLocations.reserve(zone.locationCount);
+
+		for (uint32_t j = 0; j < zone.locationCount; ++j)
+		{
+			const CacheLocation& record = locations[zone.firstLocation + j];
+			if (!inRange(record.firstDestination, record.destinationCount, header.destinationCount))
+				return false;
+
+			ParsedFindableLocation& location = zoneLocations.emplace_back();
+			location.typeString = getString(record.typeString);
+			location.type = (LocationType)record.type;
+			if (record.hasLocation)
+				location.location = glm::vec3(record.location[0], record.location[1], record.location[2]);
+			location.name = getString(record.name);
+			location.targetZone = getString(record.targetZone);
+			location.zoneId = location.targetZone.empty() ? 0 : ResolveTargetZoneName(location.targetZone);
+			location.zoneIdentifier = record.zoneIdentifier;
+			location.switchId = record.switchId;
+			location.switchName = getString(record.switchName);
+			location.luaScript = getString(record.luaScript);
+			location.luaScriptFile = getString(record.luaScriptFile);
+			location.replace = record.replace != 0;
+			location.remove = record.remove != 0;
+			location.cost = record.cost;
+			location.requiredExpansions = (EQExpansionOwned)record.requiredExpansions;
+			location.requiredAchievement = record.requiredAchievement;
+			location.requiredAchievementName = getString(record.requiredAchievementName);
+
+			location.translocatorDestinations.reserve(record.destinationCount);
+			for (uint32_t k = 0; k < record.destinationCount; ++k)
+			{
+				const CacheDestination& destRecord = destinations[record.firstDestination + k];
+
+				ParsedTranslocatorDestination& dest = location.translocatorDestinations.emplace_back();
+				dest.keyword = getString(destRecord.keyword);
+				dest.targetZone = getString(destRecord.targetZone);
+				dest.zoneId = ResolveTargetZoneName(dest.targetZone);
+				dest.zoneIdentifier = destRecord.zoneIdentifier;
+			}
+		}
+	}
+
+	data.sectionsHash = header.sectionsHash;
+
+	data.zoneGroups.reserve(header.groupCount);
+	for (uint32_t i = 0; i < header.groupCount; ++i)
+	{
+		const CacheZoneGroup& group = groups[i];
+		if (!inRange(group.firstZone, group.zoneCount, header.groupZoneCount))
+			return false;
+
+		auto& [groupName, zoneNames] = data.zoneGroups.emplace_back();
+		groupName = getString(group.name);
+
+		zoneNames.reserve(group.zoneCount);
+		for (uint32_t j = 0; j < group.zoneCount; ++j)
+			zoneNames.push_back(getString(groupZones[group.firstZone + j]));
+	}
+
+	data.teleports.reserve(header.teleportCount);
+	for (uint32_t i = 0; i < header.teleportCount; ++i)
+	{
+		const CacheTeleport& record = teleports[i];
+		if (!inRange(record.firstClass, record.classCount, header.teleportClassCount))
+			return false;
+
+		ParsedTeleport& teleport = data.teleports.emplace_back();
+		teleport.name = getString(record.name);
+		teleport.command = getString(record.command);
+		teleport.spell = getString(record.spell);
+		teleport.targetZone = getString(record.targetZone);
+		teleport.condition = getString(record.condition);
+		teleport.level = record.level;
+		teleport.castTime = record.castTime;
+		teleport.cooldown = record.cooldown;
+		teleport.cost = record.cost;
+
+		teleport.classes.reserve(record.classCount);
+		for (uint32_t j = 0; j < record.classCount; ++j)
+			teleport.classes.push_back(getString(teleportClasses[record.firstClass + j]));
+	}
+
+	if (!valid)
+		return false;
+
+	outData = std::move(data);
+	return true;
+}
+
+bool ZoneConnectionsCache_Write(const std::string& cacheFile, const ZoneConnectionsSource& source,
+	const ZoneConnectionsData& data)
+{
+	std::string strings;
+	std::unordered_map<std::string, CacheString> stringOffsets;
+
+	// Strings are stored once no matter how many records use them.
+	auto addString = [&](const std::string& str)
+	{
+		auto [iter, inserted] = stringOffsets.try_emplace(str);
+		if (inserted)
+		{
+			iter->second = { (uint32_t)strings.size(), (uint32_t)str.size() };
+			strings.append(str);
+		}
+
+		return iter->second;
+	};
+
+	std::vector<CacheZone> zones;
+	std::vector<CacheLocation> locations;
+	std::vector<CacheDestination> destinations;
+	zones.reserve(data.findLocations.size());
+
+	for (const auto& [shortName, zoneLocations] : data.findLocations)
+	{
+		CacheZone& zone = zones.emplace_back();
+		zone.shortName = addString(shortName);
+		zone.firstLocation = (uint32_t)locations.size();
+		zone.locationCount = (uint32_t)zoneLocations.size();
+
+		auto hashIter = data.zoneHashes.find(shortName);
+		zone.hash = hashIter != data.zoneHashes.end() ? hashIter->second : 0;
+
+		for (const ParsedFindableLocation& location : zoneLocations)
+		{
+			CacheLocation& record = locations.emplace_back();
+			record.typeString = addString(location.typeString);
+			record.name = addString(location.name);
+			record.switchName = addString(location.switchName);
+			record.luaScript = addString(location.luaScript);
+			record.luaScriptFile = addString(location.luaScriptFile);
+			record.requiredAchievementName = addString(location.requiredAchievementName);
+			record.requiredExpansions = (uint64_t)location.requiredExpansions;
+			if (location.location)
+			{
+				record.location[0] = location.location->x;
+				record.location[1] = location.location->y;
+				record.location[2] = location.location->z;
+			}
+			record.targetZone = addString(location.targetZone);
+			record.zoneIdentifier = location.zoneIdentifier;
+			record.switchId = location.switchId;
+			record.cost = location.cost;
+			record.requiredAchievement = location.requiredAchievement;
+			record.firstDestination = (uint32_t)destinations.size();
+			record.destinationCount = (uint32_t)location.translocatorDestinations.size();
+			record.type = (uint8_t)location.type;
+			record.hasLocation = location.location.has_value();
+			record.replace = location.replace;
+			record.remove = location.remove;
+
+			for (const ParsedTranslocatorDestination& dest : location.translocatorDestinations)
+			{
+				CacheDestination& destRecord = destinations.emplace_back();
+				destRecord.keyword = addString(dest.keyword);
+				destRecord.targetZone = addString(dest.targetZone);
+				destRecord.zoneIdentifier = dest.zoneIdentifier;
+			}
+		}
+	}
+
+	std::vector<CacheZoneGroup> groups;
+	std::vector<CacheString> groupZones;
+	groups.reserve(data.zoneGroups.size());
+
+	for (const auto& [groupName, zoneNames] : data.zoneGroups)
+	{
+		CacheZoneGroup& group = groups.emplace_back();
+		group.name = addString(groupName);
+		group.firstZone = (uint32_t)groupZones.size();
+		group.zoneCount = (uint32_t)zoneNames.size();
+
+		for (const std::string& zoneName : zoneNames)
+			groupZones.push_back(addString(zoneName));
+	}
+
+	std::vector<CacheTeleport> teleports;
+	std::vector<CacheString> teleportClasses;
+	teleports.reserve(data.teleports.size());
+
+	for (const ParsedTeleport& teleport : data.teleports)
+	{
+		CacheTeleport& record = teleports.emplace_back();
+		record.name = addString(teleport.name);
+		record.command = addString(teleport.command);
+		record.spell = addString(teleport.spell);
+		record.targetZone = addString(teleport.targetZone);
+		record.condition = addString(teleport.condition);
+		record.firstClass = (uint32_t)teleportClasses.size();
+		record.classCount = (uint32_t)teleport.classes.size();
+		record.level = teleport.level;
+		record.castTime = teleport.castTime;
+		record.cooldown = teleport.cooldown;
+		record.cost = teleport.cost;
+
+		for (const std::string& className : teleport.classes)
+			teleportClasses.push_back(addString(className));
+	}
+
+	CacheHeader header = {};
+	header.magic = CacheMagic;
+	header.version = CacheVersion;
+	header.sourceSize = source.size;
+	header.sourceModifiedTime = source.modifiedTime;
+	header.sourceHash = source.contentHash;
+	header.sectionsHash = data.sectionsHash;
+	header.zoneCount = (uint32_t)zones.size();
+	header.locationCount = (uint32_t)locations.size();
+	header.destinationCount = (uint32_t)destinations.size();
+	header.groupCount = (uint32_t)groups.size();
+	header.groupZoneCount = (uint32_t)groupZones.size();
+	header.teleportCount = (uint32_t)teleports.size();
+	header.teleportClassCount = (uint32_t)teleportClasses.size();
+	header.stringSize = (uint32_t)strings.size();
+
+	CacheLayout layout = GetCacheLayout(header);
+
+	// Write to a temporary file first, so that a cache is never left half written. Loads that overlap
+	// can both be writing the cache, so take turns with the temporary file.
+	static std::mutex s_writeMutex;
+	std::scoped_lock lock(s_writeMutex);
+
+	std::string tempFile = cacheFile + ".tmp";
+	std::error_code ec;
+
+	{
+		std::ofstream out(tempFile, std::ios::binary | std::ios::trunc);
+		if (!out.is_open())
+			return false;
+
+		uint64_t position = 0;
+		auto writeSection = [&](uint64_t offset, const void* sectionData, size_t size)
+		{
+			static const char padding[8] = {};
+			out.write(padding, (std::streamsize)(offset - position));
+			out.write(static_cast<const char*>(sectionData), (std::streamsize)size);
+			position = offset + size;
+		};
+
+		writeSection(0, &header, sizeof(header));
+		writeSection(layout.zones, zones.data(), zones.size() * sizeof(CacheZone));
+		writeSection(layout.locations, locations.data(), locations.size() * sizeof(CacheLocation));
+		writeSection(layout.destinations, destinations.data(), destinations.size() * sizeof(CacheDestination));
+		writeSection(layout.groups, groups.data(), groups.size() * sizeof(CacheZoneGroup));
+		writeSection(layout.groupZones, groupZones.data(), groupZones.size() * sizeof(CacheString));
+		writeSection(layout.teleports, teleports.data(), teleports.size() * sizeof(CacheTeleport));
+		writeSection(layout.teleportClasses, teleportClasses.data(), teleportClasses.size() * sizeof(CacheString));
+		writeSection(layout.strings, strings.data(), strings.size());
+
+		out.flush();
+		if (!out.good())
+		{
+			out.close();
+			fs::remove(tempFile, ec);
+			return false;
+		}
+	}
+
+	fs::rename(tempFile, cacheFile, ec);
+	if (ec)
+	{
+		fs::remove(tempFile, ec);
+		return false;
+	}
+
+	return true;
+}
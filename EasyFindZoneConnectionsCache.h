@@ -0,0 +1,21 @@
+#pragma once
+
+#include "EasyFindZoneConnections.h"
+
+// Compiled form of ZoneConnections.yaml, written next to it so that later startups can skip
+// parsing the YAML. The cache records which version of the file it was compiled from, and is
+// ignored as soon as the file changes.
+struct ZoneConnectionsSource
+{
+	uint64_t size = 0;
+	int64_t modifiedTime = 0;
+	uint64_t contentHash = 0;
+};
+
+// Reads a compiled cache. Returns false if it is missing, damaged, or wasn't compiled from `source`.
+bool ZoneConnectionsCache_Read(const std::string& cacheFile, const ZoneConnectionsSource& source,
+	ZoneConnectionsData& outData);
+
+// Compiles zone connections into a cache file. Doesn't touch any game state, so it can run on any thread.
+bool ZoneConnectionsCache_Write(const std::string& cacheFile, const ZoneConnectionsSource& source,
+	const ZoneConnectionsData& data);
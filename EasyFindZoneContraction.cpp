@@ -0,0 +1,387 @@
+
+#include "EasyFind.h"
+#include "EasyFindZoneContraction.h"
+
+#include <chrono>
+
+// std heap functions build a max heap, so order by greater to pop the closest zone first.
+static bool HeapCompare(const std::pair<uint32_t, ZoneOrdinal>& a, const std::pair<uint32_t, ZoneOrdinal>& b)
+{
+	return a.first > b.first;
+}
+
+std::shared_ptr<const ZoneContraction> ZoneContraction::Build(std::shared_ptr<const ZoneGraph> graph)
+{
+	if (!graph)
+		return nullptr;
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	auto contraction = std::make_shared<ZoneContraction>();
+	contraction->m_graph = graph;
+
+	int nodeCount = graph->GetNodeCount();
+
+	// Zones connected in either direction, sorted. Universal edges are left out, they arrive from everywhere.
+	std::vector<std::vector<ZoneOrdinal>> neighbors(nodeCount);
+
+	for (int i = 0; i < nodeCount; ++i)
+	{
+		for (const ZoneGraphEdge* edge = graph->EdgesBegin((ZoneOrdinal)i); edge != graph->EdgesEnd((ZoneOrdinal)i); ++edge)
+		{
+			if (edge->destination != i)
+			{
+				neighbors[i].push_back(edge->destination);
+				neighbors[edge->destination].push_back((ZoneOrdinal)i);
+			}
+		}
+	}
+
+	int connectionCount = 0;
+	for (auto& list : neighbors)
+	{
+		std::sort(list.begin(), list.end());
+		list.erase(std::unique(list.begin(), list.end()), list.end());
+		connectionCount += (int)list.size();
+	}
+
+	// Contract the zone with the fewest remaining neighbors, joining those neighbors to each other.
+	// The neighbors that are left when a zone is contracted become its arcs.
+	std::vector<std::vector<ZoneOrdinal>> arcs(nodeCount);
+	std::vector<bool> contracted(nodeCount, false);
+	contraction->m_rank.resize(nodeCount);
+	contraction->m_order.reserve(nodeCount);
+
+	for (int step = 0; step < nodeCount; ++step)
+	{
+		int next = -1;
+		for (int i = 0; i < nodeCount; ++i)
+		{
+			if (!contracted[i] && (next == -1 || neighbors[i].size() < neighbors[next].size()))
+				next = i;
+		}
+
+		ZoneOrdinal current = (ZoneOrdinal)next;
+		contracted[current] = true;
+		contraction->m_rank[current] = (uint16_t)step;
+		contraction->m_order.push_back(current);
+
+		arcs[current] = std::move(neighbors[current]);
+		neighbors[current].clear();
+
+		for (ZoneOrdinal neighbor : arcs[current])
+		{
+			std::vector<ZoneOrdinal>& list = neighbors[neighbor];
+			list.erase(std::lower_bound(list.begin(), list.end(), current));
+
+			for (ZoneOrdinal other : arcs[current])
+			{
+				auto iter = std::lower_bound(list.begin(), list.end(), other);
+				if (other != neighbor && (iter == list.end() || *iter != other))
+					list.insert(iter, other);
+			}
+		}
+	}
+
+	contraction->m_arcOffsets.resize(nodeCount + 1);
+
+	for (int i = 0; i < nodeCount; ++i)
+	{
+		contraction->m_arcOffsets[i] = (uint32_t)contraction->m_arcHeads.size();
+		contraction->m_arcHeads.insert(contraction->m_arcHeads.end(), arcs[i].begin(), arcs[i].end());
+		contraction->m_arcTails.insert(contraction->m_arcTails.end(), arcs[i].size(), (ZoneOrdinal)i);
+	}
+
+	contraction->m_arcOffsets[nodeCount] = (uint32_t)contraction->m_arcHeads.size();
+
+	// Every connection was counted from both ends.
+	contraction->m_shortcutCount = contraction->GetArcCount() - connectionCount / 2;
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+	contraction->m_buildTime = elapsed.count();
+
+	SPDLOG_DEBUG("Contracted zone graph: {} arcs, {} shortcuts in {:.2f} ms",
+		contraction->GetArcCount(), contraction->m_shortcutCount, contraction->m_buildTime);
+
+	return contraction;
+}
+
+size_t ZoneContraction::GetMemoryUsage() const
+{
+	return sizeof(*this)
+		+ m_rank.capacity() * sizeof(uint16_t)
+		+ m_order.capacity() * sizeof(ZoneOrdinal)
+		+ m_arcOffsets.capacity() * sizeof(uint32_t)
+		+ m_arcHeads.capacity() * sizeof(ZoneOrdinal)
+		+ m_arcTails.capacity() * sizeof(ZoneOrdinal);
+}
+
+uint32_t ZoneContraction::FindArc(ZoneOrdinal a, ZoneOrdinal b) const
+{
+	if (m_rank[a] > m_rank[b])
+		std::swap(a, b);
+
+	auto begin = m_arcHeads.begin() + m_arcOffsets[a];
+	auto end = m_arcHeads.begin() + m_arcOffsets[a + 1];
+
+	auto iter = std::lower_bound(begin, end, b);
+	return iter != end && *iter == b ? (uint32_t)(iter - m_arcHeads.begin()) : NoArc;
+}
+
+//============================================================================
+
+std::shared_ptr<const ZoneContractionMetric> ZoneContractionMetric::Customize(
+	std::shared_ptr<const ZoneContraction> contraction, ZonePathRoutingMode mode, std::shared_ptr<const ZoneEdgeMask> edgeMask)
+{
+	// The bottleneck cost of a route isn't a sum, so shortcuts can't stand in for it.
+	if (!contraction || !edgeMask || mode == ZonePathRoutingMode::LowestLevel)
+		return nullptr;
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	const ZoneContraction& topology = *contraction;
+	const ZoneGraph& graph = *topology.m_graph;
+
+	auto metric = std::make_shared<ZoneContractionMetric>();
+	metric->m_contraction = contraction;
+	metric->m_edgeMask = edgeMask;
+	metric->m_mode = mode;
+	metric->m_hasUniversalEdges = graph.HasUniversalEdges(*edgeMask);
+	metric->m_up.resize(topology.GetArcCount());
+	metric->m_down.resize(topology.GetArcCount());
+
+	// Start with the cheapest usable connection in each direction.
+	for (int i = 0; i < graph.GetNodeCount(); ++i)
+	{
+		for (const ZoneGraphEdge* edge = graph.EdgesBegin((ZoneOrdinal)i); edge != graph.EdgesEnd((ZoneOrdinal)i); ++edge)
+		{
+			uint32_t index = graph.GetEdgeIndex(edge);
+			if (edge->destination == i || !edgeMask->Test(index))
+				continue;
+
+			uint32_t arc = topology.FindArc((ZoneOrdinal)i, edge->destination);
+			ArcCost& arcCost = topology.m_rank[i] < topology.m_rank[edge->destination] ? metric->m_up[arc] : metric->m_down[arc];
+
+			uint32_t cost = mode == ZonePathRoutingMode::FewestZones ? 1 : edge->cost;
+			if (cost < arcCost.cost)
+				arcCost = { cost, index, InvalidZoneOrdinal };
+		}
+	}
+
+	// Then route each pair of a zone's arcs through it, lowest zones first. By the time a zone is
+	// reached, its own arcs already have their final costs.
+	for (ZoneOrdinal middle : topology.m_order)
+	{
+		uint32_t begin = topology.m_arcOffsets[middle];
+		uint32_t end = topology.m_arcOffsets[middle + 1];
+
+		for (uint32_t first = begin; first < end; ++first)
+		{
+			for (uint32_t second = first + 1; second < end; ++second)
+			{
+				// Order the pair so that `low` was contracted before `high`.
+				uint32_t low = first;
+				uint32_t high = second;
+				if (topology.m_rank[topology.m_arcHeads[low]] > topology.m_rank[topology.m_arcHeads[high]])
+					std::swap(low, high);
+
+				uint32_t arc = topology.FindArc(topology.m_arcHeads[low], topology.m_arcHeads[high]);
+
+				// low -> middle -> high
+				const ArcCost& lowToMiddle = metric->m_down[low];
+				const ArcCost& middleToHigh = metric->m_up[high];
+				if (lowToMiddle.cost != UINT32_MAX && middleToHigh.cost != UINT32_MAX
+					&& lowToMiddle.cost + middleToHigh.cost < metric->m_up[arc].cost)
+				{
+					metric->m_up[arc] = { lowToMiddle.cost + middleToHigh.cost, NoEdge, middle };
+				}
+
+				// high -> middle -> low
+				const ArcCost& highToMiddle = metric->m_down[high];
+				const ArcCost& middleToLow = metric->m_up[low];
+				if (highToMiddle.cost != UINT32_MAX && middleToLow.cost != UINT32_MAX
+					&& highToMiddle.cost + middleToLow.cost < metric->m_down[arc].cost)
+				{
+					metric->m_down[arc] = { highToMiddle.cost + middleToLow.cost, NoEdge, middle };
+				}
+			}
+		}
+	}
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+	metric->m_customizeTime = elapsed.count();
+
+	SPDLOG_DEBUG("Customized zone contraction for {} in {:.2f} ms", ZonePathRoutingModeToString(mode), metric->m_customizeTime);
+
+	return metric;
+}
+
+size_t ZoneContractionMetric::GetMemoryUsage() const
+{
+	return sizeof(*this) + (m_up.capacity() + m_down.capacity()) * sizeof(ArcCost);
+}
+
+void ZoneContractionMetric::UnpackArc(uint32_t arc, bool up, std::vector<uint32_t>& outEdges) const
+{
+	const ArcCost& arcCost = up ? m_up[arc] : m_down[arc];
+
+	if (arcCost.edge != NoEdge)
+	{
+		outEdges.push_back(arcCost.edge);
+		return;
+	}
+
+	uint32_t toTail = m_contraction->FindArc(arcCost.middle, m_contraction->m_arcTails[arc]);
+	uint32_t toHead = m_contraction->FindArc(arcCost.middle, m_contraction->m_arcHeads[arc]);
+
+	if (up)
+	{
+		UnpackArc(toTail, false, outEdges);
+		UnpackArc(toHead, true, outEdges);
+	}
+	else
+	{
+		UnpackArc(toHead, false, outEdges);
+		UnpackArc(toTail, true, outEdges);
+	}
+}
+
+// Per thread search state. Zones are reset lazily by stamping them with the query they were last
+// touched by, so a query only pays for the zones it visits.
+struct ZoneContractionQueryState
+{
+	std::vector<uint32_t> distance[2];
+	std::vector<uint32_t> prevArc[2];
+	std::vector<uint32_t> stamp[2];
+	std::vector<std::pair<uint32_t, ZoneOrdinal>> heap[2];
+	uint32_t currentStamp = 0;
+
+	void Reset(int nodeCount)
+	{
+		if ((int)stamp[0].size() != nodeCount || ++currentStamp == 0)
+		{
+			for (int side = 0; side < 2; ++side)
+			{
+				distance[side].assign(nodeCount, UINT32_MAX);
+				prevArc[side].assign(nodeCount, UINT32_MAX);
+				stamp[side].assign(nodeCount, 0);
+			}
+
+			currentStamp = 1;
+		}
+
+		heap[0].clear();
+		heap[1].clear();
+	}
+
+	uint32_t GetDistance(int side, ZoneOrdinal ordinal) const
+	{
+		return stamp[side][ordinal] == currentStamp ? distance[side][ordinal] : UINT32_MAX;
+	}
+
+	void SetDistance(int side, ZoneOrdinal ordinal, uint32_t value, uint32_t arc)
+	{
+		stamp[side][ordinal] = currentStamp;
+		distance[side][ordinal] = value;
+		prevArc[side][ordinal] = arc;
+		heap[side].emplace_back(value, ordinal);
+		std::push_heap(heap[side].begin(), heap[side].end(), HeapCompare);
+	}
+};
+
+static thread_local ZoneContractionQueryState s_queryState;
+
+bool ZoneContractionMetric::FindPath(ZoneOrdinal from, ZoneOrdinal to, std::vector<ZonePathNode>& outPath, int* nodesExpanded) const
+{
+	outPath.clear();
+
+	const ZoneContraction& topology = *m_contraction;
+	const ZoneGraph& graph = *topology.m_graph;
+	int nodeCount = graph.GetNodeCount();
+
+	if (from >= nodeCount || to >= nodeCount || from == to || m_hasUniversalEdges)
+		return false;
+
+	// Search upward from both ends, forward from `from` and backward from `to`. The best route
+	// climbs to its highest zone and comes back down, so the two searches meet there.
+	ZoneContractionQueryState& state = s_queryState;
+	state.Reset(nodeCount);
+	state.SetDistance(0, from, 0, NoEdge);
+	state.SetDistance(1, to, 0, NoEdge);
+
+	uint32_t best = UINT32_MAX;
+	ZoneOrdinal meet = InvalidZoneOrdinal;
+	int expanded = 0;
+
+	while (!state.heap[0].empty() || !state.heap[1].empty())
+	{
+		int side = state.heap[1].empty()
+			|| (!state.heap[0].empty() && state.heap[0].front().first <= state.heap[1].front().first) ? 0 : 1;
+
+		// Both searches have gone past the best route.
+		if (state.heap[side].front().first >= best)
+			break;
+
+		std::pop_heap(state.heap[side].begin(), state.heap[side].end(), HeapCompare);
+		auto [currentDistance, current] = state.heap[side].back();
+		state.heap[side].pop_back();
+
+		if (currentDistance > state.GetDistance(side, current))
+			continue;
+
+		++expanded;
+
+		uint32_t otherDistance = state.GetDistance(1 - side, current);
+		if (otherDistance != UINT32_MAX && currentDistance + otherDistance < best)
+		{
+			best = currentDistance + otherDistance;
+			meet = current;
+		}
+
+		const std::vector<ArcCost>& costs = side == 0 ? m_up : m_down;
+
+		for (uint32_t arc = topology.m_arcOffsets[current]; arc < topology.m_arcOffsets[current + 1]; ++arc)
+		{
+			if (costs[arc].cost == UINT32_MAX)
+				continue;
+
+			ZoneOrdinal next = topology.m_arcHeads[arc];
+			uint32_t newDistance = currentDistance + costs[arc].cost;
+
+			if (newDistance < state.GetDistance(side, next))
+				state.SetDistance(side, next, newDistance, arc);
+		}
+	}
+
+	if (nodesExpanded)
+		*nodesExpanded = expanded;
+
+	if (meet == InvalidZoneOrdinal)
+		return true;
+
+	// Unpack the arcs on the way up to the meeting zone, then the ones on the way back down.
+	std::vector<uint32_t> upArcs;
+	for (ZoneOrdinal current = meet; current != from; current = topology.m_arcTails[state.prevArc[0][current]])
+		upArcs.push_back(state.prevArc[0][current]);
+
+	std::vector<uint32_t> edges;
+	for (auto iter = upArcs.rbegin(); iter != upArcs.rend(); ++iter)
+		UnpackArc(*iter, true, edges);
+
+	for (ZoneOrdinal current = meet; current != to; current = topology.m_arcTails[state.prevArc[1][current]])
+		UnpackArc(state.prevArc[1][current], false, edges);
+
+	outPath.reserve(edges.size() + 1);
+
+	ZoneOrdinal current = from;
+	for (uint32_t index : edges)
+	{
+		const ZoneGraphEdge& edge = graph.GetEdge(index);
+
+		outPath.push_back(ZoneGraph::MakePathNode(graph.GetNode(current).zoneId, &edge));
+		current = edge.destination;
+	}
+
+	outPath.emplace_back(graph.GetNode(current).zoneId, -1, 0, nullptr);
+	return true;
+}
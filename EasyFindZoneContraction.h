@@ -0,0 +1,88 @@
+#pragma once
+
+#include "EasyFindZoneGraph.h"
+
+// Contraction hierarchy over the zone graph. Zones are contracted one at a time, fewest neighbors
+// first, and every pair of neighbors that a contracted zone leaves behind is joined by a shortcut.
+// The shortcuts don't depend on edge costs, so the contraction only has to be redone when the graph
+// itself changes. Edge costs are applied afterwards by ZoneContractionMetric, which is cheap enough
+// to redo whenever requirements change.
+class ZoneContraction
+{
+public:
+	// Contracts the zone connections of a graph. Slow on large graphs, so run it off the game thread.
+	static std::shared_ptr<const ZoneContraction> Build(std::shared_ptr<const ZoneGraph> graph);
+
+	const std::shared_ptr<const ZoneGraph>& GetGraph() const { return m_graph; }
+
+	int GetArcCount() const { return (int)m_arcHeads.size(); }
+	int GetShortcutCount() const { return m_shortcutCount; }
+	double GetBuildTime() const { return m_buildTime; }      // milliseconds
+	size_t GetMemoryUsage() const;
+
+private:
+	friend class ZoneContractionMetric;
+
+	static constexpr uint32_t NoArc = UINT32_MAX;
+
+	// Returns the arc between two zones, or NoArc if they aren't connected.
+	uint32_t FindArc(ZoneOrdinal a, ZoneOrdinal b) const;
+
+	std::shared_ptr<const ZoneGraph> m_graph;
+	std::vector<uint16_t> m_rank;                         // contraction order by ordinal
+	std::vector<ZoneOrdinal> m_order;                     // ordinal by contraction order
+	std::vector<uint32_t> m_arcOffsets;                   // arcs to zones that were contracted later
+	std::vector<ZoneOrdinal> m_arcHeads;                  // sorted by ordinal for each zone
+	std::vector<ZoneOrdinal> m_arcTails;
+	int m_shortcutCount = 0;
+	double m_buildTime = 0;
+};
+
+// Edge costs of a contraction for one routing mode and set of usable edges.
+class ZoneContractionMetric
+{
+public:
+	// Applies edge costs to the shortcuts, lowest zones first. Returns null if the routing mode
+	// can't be expressed as a sum of edge costs.
+	static std::shared_ptr<const ZoneContractionMetric> Customize(std::shared_ptr<const ZoneContraction> contraction,
+		ZonePathRoutingMode mode, std::shared_ptr<const ZoneEdgeMask> edgeMask);
+
+	const std::shared_ptr<const ZoneContraction>& GetContraction() const { return m_contraction; }
+	const std::shared_ptr<const ZoneGraph>& GetGraph() const { return m_contraction->GetGraph(); }
+	const std::shared_ptr<const ZoneEdgeMask>& GetEdgeMask() const { return m_edgeMask; }
+	ZonePathRoutingMode GetMode() const { return m_mode; }
+
+	double GetCustomizeTime() const { return m_customizeTime; }   // milliseconds
+	size_t GetMemoryUsage() const;
+
+	// Finds the cheapest route from `from` to `to`, leaving outPath empty if there is none. Returns
+	// false if the query can't be answered here and the flat search should be used instead.
+	bool FindPath(ZoneOrdinal from, ZoneOrdinal to, std::vector<ZonePathNode>& outPath, int* nodesExpanded = nullptr) const;
+
+private:
+	static constexpr uint32_t NoEdge = UINT32_MAX;
+
+	// Cost of an arc in one direction, and how to unpack it: either a graph edge, or the two arcs
+	// through a zone that was contracted earlier.
+	struct ArcCost
+	{
+		uint32_t cost = UINT32_MAX;
+		uint32_t edge = NoEdge;
+		ZoneOrdinal middle = InvalidZoneOrdinal;
+	};
+
+	// Appends the graph edges that an arc stands for. `up` goes from the tail to the head.
+	void UnpackArc(uint32_t arc, bool up, std::vector<uint32_t>& outEdges) const;
+
+	std::shared_ptr<const ZoneContraction> m_contraction;
+	std::shared_ptr<const ZoneEdgeMask> m_edgeMask;
+	ZonePathRoutingMode m_mode = ZonePathRoutingMode::FewestZones;
+	bool m_hasUniversalEdges = false;
+	std::vector<ArcCost> m_up;                            // tail to head, by arc
+	std::vector<ArcCost> m_down;                          // head to tail
+	double m_customizeTime = 0;
+};
+
+// Returns the contraction metric for the current zone graph and requirements. Null until the
+// background contraction finishes.
+std::shared_ptr<const ZoneContractionMetric> ZonePath_GetContractionMetric();
@@ -0,0 +1,2022 @@
+
+#include "EasyFind.h"
+#include "EasyFindConfiguration.h"
+#include "EasyFindZoneConnections.h"
+#include "EasyFindZoneContraction.h"
+#include "EasyFindZoneGraph.h"
+#include "EasyFindZoneHierarchy.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+// The zone guide and zone connections are copied on the game thread and the graph is built from the
+// copy in the background. Everything built from the graph is published from the pulse the same way.
+static std::shared_ptr<const ZoneGraph> s_zoneGraph;
+static std::future<std::shared_ptr<const ZoneGraph>> s_zoneGraphBuild;
+static bool s_zoneGraphDirty = true;
+static int s_zoneGraphGeneration = 0;                 // bumped whenever a graph in flight goes stale
+static int s_zoneGraphBuildGeneration = 0;
+
+// Each routing mode is answered by one precomputed structure, and searches fall back to the graph
+// while it is being built:
+//   Fewest Zones, Fastest Travel - the contraction, or the continent hierarchy until it is built
+//   Fastest Travel with arrival points - nothing, FindPathByArrival searches the graph
+//   Lowest Level Zones - the routing table, since the others can't minimize the highest zone level
+
+static std::shared_ptr<const ZoneRoutingTable> s_routingTable;
+static std::future<std::shared_ptr<const ZoneRoutingTable>> s_routingTableBuild;
+static bool s_routingTableDirty = true;
+static int s_routingTableGeneration = 0;              // bumped whenever a table in flight goes stale
+static int s_routingTableBuildGeneration = 0;
+
+// Built when the graph has no contraction yet, and much sooner. Dropped once the contraction is customized.
+static std::shared_ptr<const ZoneHierarchy> s_hierarchy;
+static std::future<std::shared_ptr<const ZoneHierarchy>> s_hierarchyBuild;
+
+// Rebuilt in the background when the graph or edge mask changes.
+static std::shared_ptr<const ZoneReachability> s_reachability;
+static std::future<std::shared_ptr<const ZoneReachability>> s_reachabilityBuild;
+
+// Contracted once per graph in the background. Requirement changes only need the costs customized again.
+static std::shared_ptr<const ZoneContraction> s_contraction;
+static std::future<std::shared_ptr<const ZoneContraction>> s_contractionBuild;
+static std::shared_ptr<const ZoneContractionMetric> s_contractionMetric;
+static std::future<std::shared_ptr<const ZoneContractionMetric>> s_contractionMetricBuild;
+static std::shared_ptr<const ZoneEdgeMask> s_contractionMetricMask;  // mask the metric was customized for
+
+// Usable edges of s_zoneGraph, re-evaluated from the pulse.
+static std::shared_ptr<const ZoneEdgeMask> s_edgeMask;
+static std::chrono::steady_clock::time_point s_nextRequirementsCheck;
+
+// s_edgeMask without the teleports that aren't ready. Checking a teleport evaluates macros, so this
+// is kept for a second rather than redone for every search.
+static std::shared_ptr<const ZoneEdgeMask> s_readyEdgeMask;
+static std::shared_ptr<const ZoneEdgeMask> s_readyEdgeMaskBase;      // mask it was made from
+static std::chrono::steady_clock::time_point s_readyEdgeMaskExpiry;
+
+//============================================================================
+
+// Time spent on top of the transfer itself, e.g. hailing a translocator and waiting on it.
+static int GetLocationTypePenalty(LocationType type)
+{
+	switch (type)
+	{
+	case LocationType::Switch: return 5;
+	case LocationType::Translocator: return 20;
+	case LocationType::Location:
+	case LocationType::Unknown:
+	default: return 0;
+	}
+}
+
+// Rough distance a character covers per second while running, used to turn distances into edge costs.
+static constexpr float RunSpeed = 40.0f;
+
+static uint32_t GetEdgeCost(int transferTypeIndex, const ParsedFindableLocation* location)
+{
+	if (location && location->cost >= 0)
+		return (uint32_t)std::max(location->cost, 1);
+
+	int cost = g_configuration->GetTransferTypeCost(transferTypeIndex);
+	if (location)
+		cost += GetLocationTypePenalty(location->type);
+
+	return (uint32_t)std::max(cost, 1);
+}
+
+int ZoneGuideSnapshot::FindTransferType(std::string_view name) const
+{
+	for (int i = 0; i < (int)transferTypes.size(); ++i)
+	{
+		if (std::string_view(transferTypes[i]) == name)
+			return i;
+	}
+
+	return -1;
+}
+
+void ZoneGuideSnapshot::AddZone(Zone&& zone)
+{
+	if (zone.zoneId <= 0)
+		return;
+
+	if ((size_t)zone.zoneId >= zoneIndices.size())
+		zoneIndices.resize((size_t)zone.zoneId + 1, -1);
+
+	zoneIndices[zone.zoneId] = (int)zones.size();
+	zones.push_back(std::move(zone));
+}
+
+std::shared_ptr<const ZoneGuideSnapshot> ZoneGuideSnapshot::Capture()
+{
+	if (!pWorldData)
+		return nullptr;
+
+	ZoneGuideManagerClient& zoneMgr = ZoneGuideManagerClient::Instance();
+	auto snapshot = std::make_shared<ZoneGuideSnapshot>();
+
+	for (int i = 0; i < zoneMgr.transferTypes.GetLength(); ++i)
+		snapshot->transferTypes.emplace_back(zoneMgr.transferTypes[i].description);
+
+	for (const ZoneGuideZone& zoneGuideZone : zoneMgr.zones)
+	{
+		Zone zone;
+		zone.zoneId = zoneGuideZone.zoneId;
+		zone.minLevel = zoneGuideZone.minLevel;
+		zone.maxLevel = zoneGuideZone.maxLevel;
+		zone.continentIndex = zoneGuideZone.continentIndex;
+		zone.connections.assign(zoneGuideZone.zoneConnections.begin(), zoneGuideZone.zoneConnections.end());
+
+		snapshot->AddZone(std::move(zone));
+	}
+
+	return snapshot;
+}
+
+std::shared_ptr<const ZoneGraphSource> ZoneGraphSource::Capture(std::shared_ptr<const ZoneGuideSnapshot> zoneGuide)
+{
+	if (!zoneGuide || !g_zoneConnections || !g_configuration)
+		return nullptr;
+
+	auto source = std::make_shared<ZoneGraphSource>();
+	source->zoneGuide = std::move(zoneGuide);
+
+	const ZoneGuideSnapshot& zoneMgr = *source->zoneGuide;
+
+	int otherIndex = zoneMgr.FindTransferType("Other");
+	int zoneLineIndex = zoneMgr.FindTransferType("Zone Line");
+	int translocatorIndex = zoneMgr.FindTransferType("Translocator");
+
+	// Records one usable connection out of a zone. Expansion and achievement requirements are copied
+	// so that they can go into the edge mask instead.
+	auto addConnection = [&](EQZoneIndex zoneId, EQZoneIndex destZoneId, int transferTypeIndex, int minLevel,
+		int zoneIdentifier, const ParsedFindableLocation* location, const ZoneGuideConnection* connection)
+	{
+		Connection& added = source->connections.emplace_back();
+		added.fromZoneId = zoneId;
+		added.toZoneId = destZoneId;
+
+		ZoneGraphEdge& edge = added.edge;
+		edge.transferTypeIndex = (int16_t)transferTypeIndex;
+		edge.minLevel = (int16_t)minLevel;
+		edge.cost = GetEdgeCost(transferTypeIndex, location);
+		edge.connection = connection;
+		edge.zoneIdentifier = zoneIdentifier;
+
+		if (location)
+		{
+			edge.hasExitPoint = location->location.has_value();
+			edge.exitPoint = location->location.value_or(glm::vec3(0, 0, 0));
+			edge.fixedCost = location->cost >= 0;
+			edge.requiredExpansions = location->requiredExpansions;
+			edge.requiredAchievement = location->requiredAchievement;
+			edge.requiredAchievementName = location->requiredAchievementName;
+		}
+
+		added.gated = (location && (location->requiredExpansions != 0 || location->requiredAchievement != 0
+			|| !location->requiredAchievementName.empty()))
+			|| (connection && connection->requiredExpansions != 0);
+	};
+
+	auto visitConnections = [&](EQZoneIndex zoneId)
+	{
+		const EZZoneData& ezZoneData = g_zoneConnections->GetZoneData(zoneId);
+
+		if (const ZoneGuideSnapshot::Zone* zone = zoneMgr.GetZone(zoneId))
+		{
+			for (const ZoneGuideConnection& connection : zone->connections)
+			{
+				// Skip connection if it is disabled by the user.
+				if (connection.disabled)
+					continue;
+
+				// Make sure we didn't remove this connection
+				if (std::find(ezZoneData.removedConnections.begin(), ezZoneData.removedConnections.end(), connection.destZoneId) != ezZoneData.removedConnections.end())
+					continue;
+
+				// Make sure that the transfer types are supported
+				if (g_configuration->IsDisabledTransferType(connection.transferTypeIndex))
+					continue;
+
+				addConnection(zoneId, connection.destZoneId, connection.transferTypeIndex, zone->minLevel, 0, nullptr, &connection);
+			}
+		}
+
+		for (const ParsedFindableLocation& location : ezZoneData.findableLocations)
+		{
+			if (!location.IsZoneConnection())
+				continue;
+
+			int transferTypeIndex = otherIndex;
+
+			if (location.type == LocationType::Location)
+				transferTypeIndex = zoneLineIndex;
+			else if (location.type == LocationType::Translocator)
+				transferTypeIndex = translocatorIndex;
+
+			if (location.zoneId != 0)
+				addConnection(zoneId, location.zoneId, transferTypeIndex, 0, location.zoneIdentifier, &location, nullptr);
+			for (const auto& dest : location.translocatorDestinations)
+			{
+				if (dest.zoneId != 0)
+					addConnection(zoneId, dest.zoneId, translocatorIndex, 0, dest.zoneIdentifier, &location, nullptr);
+			}
+		}
+	};
+
+	for (const ZoneGuideSnapshot::Zone& zone : zoneMgr.zones)
+		visitConnections(zone.zoneId);
+
+	for (const EZZoneData& zoneData : g_zoneConnections->GetAllZoneData())
+	{
+		if (zoneData.zoneId == 0)
+			continue;
+
+		source->zoneIds.push_back(zoneData.zoneId);
+		if (!zoneMgr.GetZone(zoneData.zoneId))
+			visitConnections(zoneData.zoneId);
+	}
+
+	// Where a teleport goes can depend on game state, e.g. the bind point, so it is resolved here.
+	for (const ParsedTeleport& teleport : g_zoneConnections->GetTeleports())
+	{
+		Connection& added = source->teleports.emplace_back();
+		added.toZoneId = teleport.ResolveTargetZone();
+		added.edge.transferTypeIndex = (int16_t)otherIndex;
+		added.edge.cost = (uint32_t)std::max(teleport.cost >= 0 ? teleport.cost : teleport.castTime, 1);
+		added.edge.teleportName = teleport.name;
+	}
+
+	return source;
+}
+
+std::shared_ptr<const ZoneGraph> ZoneGraph::Build()
+{
+	return Build(ZoneGraphSource::Capture(ZoneGuideSnapshot::Capture()));
+}
+
+std::shared_ptr<const ZoneGraph> ZoneGraph::Build(std::shared_ptr<const ZoneGuideSnapshot> zoneGuide)
+{
+	return Build(ZoneGraphSource::Capture(std::move(zoneGuide)));
+}
+
+std::shared_ptr<const ZoneGraph> ZoneGraph::Build(std::shared_ptr<const ZoneGraphSource> source)
+{
+	if (!source)
+		return nullptr;
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	auto graph = std::make_shared<ZoneGraph>();
+	graph->m_zoneGuide = source->zoneGuide;
+
+	const ZoneGuideSnapshot& zoneMgr = *graph->m_zoneGuide;
+
+	auto addNode = [&](EQZoneIndex zoneId)
+	{
+		if (zoneId == 0)
+			return;
+
+		if ((size_t)zoneId >= graph->m_ordinals.size())
+			graph->m_ordinals.resize((size_t)zoneId + 1, InvalidZoneOrdinal);
+
+		ZoneOrdinal& ordinal = graph->m_ordinals[zoneId];
+		if (ordinal != InvalidZoneOrdinal)
+			return;
+
+		ordinal = (ZoneOrdinal)graph->m_nodes.size();
+
+		ZoneGraphNode& node = graph->m_nodes.emplace_back();
+		node.zoneId = zoneId;
+
+		if (const ZoneGuideSnapshot::Zone* zone = zoneMgr.GetZone(zoneId))
+		{
+			node.minLevel = zone->minLevel;
+			node.maxLevel = zone->maxLevel;
+			node.continentIndex = zone->continentIndex;
+		}
+	};
+
+	// Assign ordinals to every zone that is either in the zone guide or in our zone connections.
+	for (const ZoneGuideSnapshot::Zone& zone : zoneMgr.zones)
+		addNode(zone.zoneId);
+	for (EQZoneIndex zoneId : source->zoneIds)
+		addNode(zoneId);
+
+	// Destinations might not be known to either yet.
+	for (const ZoneGraphSource::Connection& connection : source->connections)
+		addNode(connection.toZoneId);
+
+	// Now pack the edges, grouped by the zone they leave with a counting sort.
+	int nodeCount = graph->GetNodeCount();
+	graph->m_edgeOffsets.assign(nodeCount + 1, 0);
+
+	for (ZoneGraphNode& node : graph->m_nodes)
+	{
+		node.minLevel = std::max(node.minLevel, 0);
+		graph->m_maxZoneLevel = std::max(graph->m_maxZoneLevel, node.minLevel);
+	}
+
+	for (const ZoneGraphSource::Connection& connection : source->connections)
+		++graph->m_edgeOffsets[graph->GetOrdinal(connection.fromZoneId) + 1];
+	for (int i = 0; i < nodeCount; ++i)
+		graph->m_edgeOffsets[i + 1] += graph->m_edgeOffsets[i];
+
+	uint32_t zoneEdgeCount = graph->m_edgeOffsets[nodeCount];
+	graph->m_edges.resize(zoneEdgeCount);
+	graph->m_edgeSources.resize(zoneEdgeCount);
+
+	std::vector<uint32_t> edgeFill(graph->m_edgeOffsets.begin(), graph->m_edgeOffsets.end() - 1);
+	for (const ZoneGraphSource::Connection& connection : source->connections)
+	{
+		ZoneOrdinal from = graph->GetOrdinal(connection.fromZoneId);
+		uint32_t index = edgeFill[from]++;
+
+		graph->m_edges[index] = connection.edge;
+		graph->m_edges[index].destination = graph->GetOrdinal(connection.toZoneId);
+		graph->m_edgeSources[index] = from;
+
+		if (connection.gated)
+			graph->m_gatedEdges.push_back(index);
+	}
+
+	// Universal edges go at the end. Whether they are ready changes all the time, so that is checked
+	// for each search by ZonePath_GetReadyEdgeMask rather than kept in the edge mask.
+	for (const ZoneGraphSource::Connection& teleport : source->teleports)
+	{
+		ZoneOrdinal destination = graph->GetOrdinal(teleport.toZoneId);
+		if (destination == InvalidZoneOrdinal)
+			continue;
+
+		graph->m_edgeSources.push_back(InvalidZoneOrdinal);
+
+		ZoneGraphEdge& edge = graph->m_edges.emplace_back(teleport.edge);
+		edge.destination = destination;
+	}
+
+	// Build the reverse adjacency with a counting sort on the destination.
+	graph->m_reverseOffsets.assign(nodeCount + 1, 0);
+	for (uint32_t i = 0; i < zoneEdgeCount; ++i)
+		++graph->m_reverseOffsets[graph->m_edges[i].destination + 1];
+	for (int i = 0; i < nodeCount; ++i)
+		graph->m_reverseOffsets[i + 1] += graph->m_reverseOffsets[i];
+
+	std::vector<uint32_t> reverseFill(graph->m_reverseOffsets.begin(), graph->m_reverseOffsets.end() - 1);
+	graph->m_reverseEdges.resize(zoneEdgeCount);
+	for (uint32_t i = 0; i < zoneEdgeCount; ++i)
+		graph->m_reverseEdges[reverseFill[graph->m_edges[i].destination]++] = i;
+
+	// Zone lines come in pairs, so arriving from a zone puts you next to the way back to it. Record
+	// that position for every zone we can actually arrive from.
+	graph->m_entryOffsets.resize(nodeCount + 1);
+
+	for (int i = 0; i < nodeCount; ++i)
+	{
+		graph->m_entryOffsets[i] = (uint32_t)graph->m_entryPoints.size();
+
+		for (const ZoneGraphEdge* edge = graph->EdgesBegin((ZoneOrdinal)i); edge != graph->EdgesEnd((ZoneOrdinal)i); ++edge)
+		{
+			const glm::vec3* exitPoint = GetExitPoint(*edge);
+			if (!exitPoint || edge->destination == i)
+				continue;
+
+			bool arrivesFrom = false;
+			for (const uint32_t* index = graph->ReverseEdgesBegin((ZoneOrdinal)i); index != graph->ReverseEdgesEnd((ZoneOrdinal)i); ++index)
+				arrivesFrom |= graph->m_edgeSources[*index] == edge->destination;
+
+			bool known = std::any_of(graph->m_entryPoints.begin() + graph->m_entryOffsets[i], graph->m_entryPoints.end(),
+				[&](const ZoneTravelPoint& entry) { return entry.zone == edge->destination; });
+
+			if (arrivesFrom && !known)
+				graph->m_entryPoints.push_back({ edge->destination, *exitPoint });
+		}
+	}
+
+	graph->m_entryOffsets[nodeCount] = (uint32_t)graph->m_entryPoints.size();
+
+	// Add the run across the zone to the cost of leaving it. Which entry point we start from depends
+	// on the route, so use the average run from all of them. Costs set explicitly are left alone.
+	for (int i = 0; i < nodeCount; ++i)
+	{
+		const ZoneTravelPoint* entriesBegin = graph->EntryPointsBegin((ZoneOrdinal)i);
+		const ZoneTravelPoint* entriesEnd = graph->EntryPointsEnd((ZoneOrdinal)i);
+		if (entriesBegin == entriesEnd)
+			continue;
+
+		for (ZoneGraphEdge* edge = &graph->m_edges[graph->m_edgeOffsets[i]]; edge != &graph->m_edges[graph->m_edgeOffsets[i + 1]]; ++edge)
+		{
+			const glm::vec3* exitPoint = GetExitPoint(*edge);
+			if (!exitPoint || edge->fixedCost)
+				continue;
+
+			uint32_t runCost = 0;
+			for (const ZoneTravelPoint* entry = entriesBegin; entry != entriesEnd; ++entry)
+				runCost += GetRunCost(entry->position, *exitPoint);
+
+			edge->runCost = runCost / (uint32_t)(entriesEnd - entriesBegin);
+			edge->cost += edge->runCost;
+		}
+	}
+
+	// Work out where each connection lands, and what leaving the destination costs from there. It
+	// lands next to the way back with the same zone identifier, or the only way back if there is one.
+	graph->m_arrivalCostOffsets.assign(zoneEdgeCount, UINT32_MAX);
+
+	for (uint32_t i = 0; i < zoneEdgeCount; ++i)
+	{
+		const ZoneGraphEdge& edge = graph->m_edges[i];
+		ZoneOrdinal source = graph->m_edgeSources[i];
+		ZoneOrdinal destination = edge.destination;
+		if (destination == source)
+			continue;
+
+		int zoneIdentifier = edge.zoneIdentifier;
+		const glm::vec3* arrivalPoint = nullptr;
+		int candidates = 0;
+
+		for (const ZoneGraphEdge* back = graph->EdgesBegin(destination); back != graph->EdgesEnd(destination); ++back)
+		{
+			const glm::vec3* exitPoint = GetExitPoint(*back);
+			if (back->destination != source || !exitPoint)
+				continue;
+
+			arrivalPoint = exitPoint;
+			++candidates;
+
+			if (zoneIdentifier > 0 && back->zoneIdentifier == zoneIdentifier)
+			{
+				candidates = 1;
+				break;
+			}
+		}
+
+		if (!arrivalPoint || candidates > 1)
+			continue;
+
+		graph->m_arrivalCostOffsets[i] = (uint32_t)graph->m_arrivalCosts.size();
+
+		for (const ZoneGraphEdge* next = graph->EdgesBegin(destination); next != graph->EdgesEnd(destination); ++next)
+			graph->m_arrivalCosts.push_back(GetCostFrom(arrivalPoint, *next));
+	}
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+	SPDLOG_DEBUG("Built zone graph: {} zones, {} connections in {:.2f} ms", graph->GetNodeCount(),
+		graph->GetEdgeCount(), elapsed.count());
+
+	return graph;
+}
+
+//============================================================================
+
+void ZoneGraphSearchState::Reset(int nodeCount)
+{
+	depth.assign(nodeCount, -1);
+	distance.assign(nodeCount, UINT32_MAX);
+	pathMinLevel.assign(nodeCount, -1);
+	prevNode.assign(nodeCount, InvalidZoneOrdinal);
+	prevEdge.assign(nodeCount, nullptr);
+	queue.clear();
+	heap.clear();
+	expanded = 0;
+}
+
+static thread_local ZoneGraphSearchState s_searchState;
+static thread_local ZoneGraphSearchState s_reverseSearchState;
+
+// Search key for LowestLevel routing: the highest zone level on the route, then the number of zones.
+static uint32_t MakeBottleneckKey(int level, int depth)
+{
+	return ((uint32_t)level << 16) | (uint32_t)depth;
+}
+
+// std heap functions build a max heap, so order by greater to pop the closest zone first.
+static bool HeapCompare(const std::pair<uint32_t, ZoneOrdinal>& a, const std::pair<uint32_t, ZoneOrdinal>& b)
+{
+	return a.first > b.first;
+}
+
+const glm::vec3* ZoneGraph::FindEntryPoint(ZoneOrdinal ordinal, ZoneOrdinal from) const
+{
+	for (const ZoneTravelPoint* entry = EntryPointsBegin(ordinal); entry != EntryPointsEnd(ordinal); ++entry)
+	{
+		if (entry->zone == from)
+			return &entry->position;
+	}
+
+	return nullptr;
+}
+
+const glm::vec3* ZoneGraph::GetExitPoint(const ZoneGraphEdge& edge)
+{
+	return edge.hasExitPoint ? &edge.exitPoint : nullptr;
+}
+
+uint32_t ZoneGraph::GetRunCost(const glm::vec3& from, const glm::vec3& to)
+{
+	float dx = to.x - from.x;
+	float dy = to.y - from.y;
+	float dz = to.z - from.z;
+
+	return (uint32_t)(std::sqrt(dx * dx + dy * dy + dz * dz) / RunSpeed + 0.5f);
+}
+
+uint32_t ZoneGraph::GetCostFrom(const glm::vec3* position, const ZoneGraphEdge& edge)
+{
+	const glm::vec3* exitPoint = GetExitPoint(edge);
+	if (!position || !exitPoint || edge.fixedCost)
+		return edge.cost;
+
+	return edge.cost - edge.runCost + GetRunCost(*position, *exitPoint);
+}
+
+ZoneEdgeMask ZoneGraph::EvaluateRequirements() const
+{
+	ZoneEdgeMask edgeMask(m_edges.size(), true);
+
+	for (uint32_t index : m_gatedEdges)
+	{
+		const ZoneGraphEdge& edge = m_edges[index];
+		bool enabled = true;
+
+		if (!edge.connection)
+		{
+			enabled = CheckFindableLocationRequirements(edge.requiredExpansions, edge.requiredAchievement,
+				edge.requiredAchievementName);
+		}
+		else if (pEverQuestInfo->bProgressionServer)
+		{
+			// Make sure that progression server expansion is available.
+			enabled = (pEverQuestInfo->ProgressionOpenExpansions & edge.connection->requiredExpansions)
+				== edge.connection->requiredExpansions;
+		}
+
+		if (!enabled)
+			edgeMask.Set(index, false);
+	}
+
+	return edgeMask;
+}
+
+bool ZoneGraph::HasUniversalEdges(const ZoneEdgeMask& edgeMask) const
+{
+	for (const ZoneGraphEdge* edge = UniversalEdgesBegin(); edge != UniversalEdgesEnd(); ++edge)
+	{
+		if (IsEdgeEnabled(edge, edgeMask))
+			return true;
+	}
+
+	return false;
+}
+
+bool ZoneGraph::AreUniversalEdgesCurrent() const
+{
+	for (const ZoneGraphEdge* edge = UniversalEdgesBegin(); edge != UniversalEdgesEnd(); ++edge)
+	{
+		// A teleport that is gone after a reload needs a new graph too.
+		const ParsedTeleport* teleport = g_zoneConnections ? g_zoneConnections->FindTeleport(edge->teleportName) : nullptr;
+		if (!teleport || GetOrdinal(teleport->ResolveTargetZone()) != edge->destination)
+			return false;
+	}
+
+	return true;
+}
+
+ZonePathNode ZoneGraph::MakePathNode(EQZoneIndex zoneId, const ZoneGraphEdge* edge)
+{
+	if (!edge)
+		return ZonePathNode(zoneId, -1, 0, nullptr);
+
+	return ZonePathNode(zoneId, edge->transferTypeIndex, edge->zoneIdentifier, edge->connection, edge->teleportName);
+}
+
+bool ZoneGraph::FindPath(ZoneOrdinal from, ZoneOrdinal to, ZonePathRoutingMode mode, const ZoneEdgeMask& edgeMask,
+	std::vector<ZonePathNode>& outPath, int* nodesExpanded) const
+{
+	outPath.clear();
+
+	int nodeCount = GetNodeCount();
+	if (from >= nodeCount || to >= nodeCount || from == to)
+		return false;
+
+	Search(from, to, mode, edgeMask, s_searchState);
+
+	if (nodesExpanded)
+		*nodesExpanded = s_searchState.expanded;
+
+	return ExtractPath(s_searchState, to, outPath);
+}
+
+// Search state for FindPathByArrival, by the edge that was taken into a zone.
+struct ZoneArrivalSearchState
+{
+	std::vector<uint32_t> distance;
+	std::vector<uint32_t> prevEdge;
+	std::vector<std::pair<uint32_t, uint32_t>> heap;
+};
+
+static thread_local ZoneArrivalSearchState s_arrivalSearchState;
+
+bool ZoneGraph::FindPathByArrival(ZoneOrdinal from, ZoneOrdinal to, const ZoneEdgeMask& edgeMask,
+	const glm::vec3* startPosition, std::vector<ZonePathNode>& outPath, int* nodesExpanded) const
+{
+	constexpr uint32_t NoEdge = UINT32_MAX;
+
+	outPath.clear();
+
+	int nodeCount = GetNodeCount();
+	if (from >= nodeCount || to >= nodeCount || from == to)
+		return false;
+
+	ZoneArrivalSearchState& state = s_arrivalSearchState;
+	state.distance.assign(m_edges.size(), UINT32_MAX);
+	state.prevEdge.assign(m_edges.size(), NoEdge);
+	state.heap.clear();
+
+	auto heapCompare = [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) { return a.first > b.first; };
+	uint32_t zoneEdgeCount = m_edgeOffsets[nodeCount];
+	int expanded = 0;
+
+	// Relaxes every edge out of `zone`, having arrived there by `arrivedBy`.
+	auto leave = [&](ZoneOrdinal zone, uint32_t arrivedBy, uint32_t currentDistance)
+	{
+		uint32_t costOffset = arrivedBy < zoneEdgeCount ? m_arrivalCostOffsets[arrivedBy] : UINT32_MAX;
+
+		for (const ZoneGraphEdge* edge = FirstEdge(zone); edge; edge = NextEdge(zone, edge))
+		{
+			uint32_t index = GetEdgeIndex(edge);
+			if (!edgeMask.Test(index))
+				continue;
+
+			uint32_t cost = edge->cost;
+			if (arrivedBy == NoEdge)
+				cost = GetCostFrom(startPosition, *edge);
+			else if (costOffset != UINT32_MAX && index < zoneEdgeCount)
+				cost = m_arrivalCosts[costOffset + index - m_edgeOffsets[zone]];
+
+			uint32_t newDistance = currentDistance + cost;
+			if (newDistance < state.distance[index])
+			{
+				state.distance[index] = newDistance;
+				state.prevEdge[index] = arrivedBy;
+				state.heap.emplace_back(newDistance, index);
+				std::push_heap(state.heap.begin(), state.heap.end(), heapCompare);
+			}
+		}
+	};
+
+	leave(from, NoEdge, 0);
+
+	uint32_t reached = NoEdge;
+
+	while (!state.heap.empty())
+	{
+		std::pop_heap(state.heap.begin(), state.heap.end(), heapCompare);
+		auto [currentDistance, current] = state.heap.back();
+		state.heap.pop_back();
+
+		if (currentDistance > state.distance[current])
+			continue;
+
+		if (m_edges[current].destination == to)
+		{
+			reached = current;
+			break;
+		}
+
+		++expanded;
+		leave(m_edges[current].destination, current, currentDistance);
+	}
+
+	if (nodesExpanded)
+		*nodesExpanded = expanded;
+
+	if (reached == NoEdge)
+		return false;
+
+	std::vector<uint32_t> edges;
+	for (uint32_t index = reached; index != NoEdge; index = state.prevEdge[index])
+		edges.push_back(index);
+
+	outPath.reserve(edges.size() + 1);
+
+	ZoneOrdinal current = from;
+	for (auto iter = edges.rbegin(); iter != edges.rend(); ++iter)
+	{
+		const ZoneGraphEdge& edge = m_edges[*iter];
+
+		outPath.push_back(MakePathNode(m_nodes[current].zoneId, &edge));
+		current = edge.destination;
+	}
+
+	outPath.emplace_back(m_nodes[current].zoneId, -1, 0, nullptr);
+	return true;
+}
+
+ZoneOrdinal ZoneGraph::FindPathToNearest(ZoneOrdinal from, const std::vector<ZoneOrdinal>& targets,
+	ZonePathRoutingMode mode, const ZoneEdgeMask& edgeMask, std::vector<ZonePathNode>& outPath, int* nodesExpanded) const
+{
+	outPath.clear();
+
+	int nodeCount = GetNodeCount();
+	if (from >= nodeCount)
+		return InvalidZoneOrdinal;
+
+	ZoneGraphSearchState& state = s_searchState;
+	state.Reset(nodeCount);
+
+	// Mark the targets in pathMinLevel, which this search doesn't otherwise need.
+	for (ZoneOrdinal target : targets)
+	{
+		if (target < nodeCount)
+			state.pathMinLevel[target] = 1;
+	}
+
+	uint32_t startDistance = mode == ZonePathRoutingMode::LowestLevel ? MakeBottleneckKey(m_nodes[from].minLevel, 0) : 0;
+
+	state.depth[from] = 0;
+	state.distance[from] = startDistance;
+	state.heap.emplace_back(startDistance, from);
+
+	ZoneOrdinal reached = InvalidZoneOrdinal;
+
+	while (!state.heap.empty())
+	{
+		std::pop_heap(state.heap.begin(), state.heap.end(), HeapCompare);
+		auto [currentDistance, current] = state.heap.back();
+		state.heap.pop_back();
+
+		if (currentDistance > state.distance[current])
+			continue;
+
+		// The first target to be settled is the closest one.
+		if (state.pathMinLevel[current] == 1)
+		{
+			reached = current;
+			break;
+		}
+
+		++state.expanded;
+
+		for (const ZoneGraphEdge* edge = FirstEdge(current); edge; edge = NextEdge(current, edge))
+		{
+			if (!IsEdgeEnabled(edge, edgeMask))
+				continue;
+
+			ZoneOrdinal dest = edge->destination;
+			uint32_t newDistance;
+
+			if (mode == ZonePathRoutingMode::LowestLevel)
+				newDistance = MakeBottleneckKey(std::max((int)(currentDistance >> 16), m_nodes[dest].minLevel), state.depth[current] + 1);
+			else
+				newDistance = currentDistance + (mode == ZonePathRoutingMode::FewestZones ? 1 : edge->cost);
+
+			if (newDistance < state.distance[dest])
+			{
+				state.distance[dest] = newDistance;
+				state.depth[dest] = state.depth[current] + 1;
+				state.prevNode[dest] = current;
+				state.prevEdge[dest] = edge;
+				state.heap.emplace_back(newDistance, dest);
+				std::push_heap(state.heap.begin(), state.heap.end(), HeapCompare);
+			}
+		}
+	}
+
+	if (nodesExpanded)
+		*nodesExpanded = state.expanded;
+
+	if (reached == InvalidZoneOrdinal)
+		return InvalidZoneOrdinal;
+
+	ExtractPath(state, reached, outPath);
+	return reached;
+}
+
+bool ZoneGraph::FindPathBidirectional(ZoneOrdinal from, ZoneOrdinal to, ZonePathRoutingMode mode,
+	const ZoneEdgeMask& edgeMask, std::vector<ZonePathNode>& outPath, int* nodesExpanded) const
+{
+	outPath.clear();
+
+	int nodeCount = GetNodeCount();
+	if (from >= nodeCount || to >= nodeCount || from == to)
+		return false;
+
+	// The bottleneck cost of a route doesn't add up from its two halves.
+	if (mode == ZonePathRoutingMode::LowestLevel || HasUniversalEdges(edgeMask))
+		return FindPath(from, to, mode, edgeMask, outPath, nodesExpanded);
+
+	// The backward search stores the next zone toward the destination in prevNode, and the edge
+	// leaving each zone in prevEdge.
+	ZoneGraphSearchState& forward = s_searchState;
+	ZoneGraphSearchState& backward = s_reverseSearchState;
+	forward.Reset(nodeCount);
+	backward.Reset(nodeCount);
+
+	auto edgeCost = [mode](const ZoneGraphEdge& edge) -> uint32_t
+	{
+		return mode == ZonePathRoutingMode::FewestZones ? 1 : edge.cost;
+	};
+
+	forward.depth[from] = 0;
+	forward.distance[from] = 0;
+	forward.heap.emplace_back(0, from);
+
+	backward.depth[to] = 0;
+	backward.distance[to] = 0;
+	backward.heap.emplace_back(0, to);
+
+	// The best route seen so far crosses this edge from the forward half to the backward half.
+	uint32_t best = UINT32_MAX;
+	ZoneOrdinal meetSource = InvalidZoneOrdinal;
+	const ZoneGraphEdge* meetEdge = nullptr;
+
+	// Called for every edge that one of the searches looks at.
+	auto checkMeet = [&](ZoneOrdinal source, const ZoneGraphEdge* edge)
+	{
+		if (forward.distance[source] == UINT32_MAX || backward.distance[edge->destination] == UINT32_MAX)
+			return;
+
+		uint32_t total = forward.distance[source] + edgeCost(*edge) + backward.distance[edge->destination];
+		if (total < best)
+		{
+			best = total;
+			meetSource = source;
+			meetEdge = edge;
+		}
+	};
+
+	while (!forward.heap.empty() && !backward.heap.empty())
+	{
+		// Once the closest zones on both sides can't produce anything shorter, we're done.
+		if (forward.heap.front().first + backward.heap.front().first >= best)
+			break;
+
+		// Expand whichever side has the smaller frontier.
+		bool expandForward = forward.heap.size() <= backward.heap.size();
+		ZoneGraphSearchState& state = expandForward ? forward : backward;
+
+		std::pop_heap(state.heap.begin(), state.heap.end(), HeapCompare);
+		auto [currentDistance, current] = state.heap.back();
+		state.heap.pop_back();
+
+		if (currentDistance > state.distance[current])
+			continue;
+
+		++state.expanded;
+
+		if (expandForward)
+		{
+			for (const ZoneGraphEdge* edge = FirstEdge(current); edge; edge = NextEdge(current, edge))
+			{
+				if (!IsEdgeEnabled(edge, edgeMask))
+					continue;
+
+				ZoneOrdinal dest = edge->destination;
+				uint32_t newDistance = currentDistance + edgeCost(*edge);
+
+				if (newDistance < forward.distance[dest])
+				{
+					forward.distance[dest] = newDistance;
+					forward.depth[dest] = forward.depth[current] + 1;
+					forward.prevNode[dest] = current;
+					forward.prevEdge[dest] = edge;
+					forward.heap.emplace_back(newDistance, dest);
+					std::push_heap(forward.heap.begin(), forward.heap.end(), HeapCompare);
+				}
+
+				checkMeet(current, edge);
+			}
+		}
+		else
+		{
+			for (const uint32_t* index = ReverseEdgesBegin(current); index != ReverseEdgesEnd(current); ++index)
+			{
+				const ZoneGraphEdge* edge = &m_edges[*index];
+				if (!IsEdgeEnabled(edge, edgeMask))
+					continue;
+
+				ZoneOrdinal source = m_edgeSources[*index];
+				uint32_t newDistance = currentDistance + edgeCost(*edge);
+
+				if (newDistance < backward.distance[source])
+				{
+					backward.distance[source] = newDistance;
+					backward.depth[source] = backward.depth[current] + 1;
+					backward.prevNode[source] = current;
+					backward.prevEdge[source] = edge;
+					backward.heap.emplace_back(newDistance, source);
+					std::push_heap(backward.heap.begin(), backward.heap.end(), HeapCompare);
+				}
+
+				checkMeet(source, edge);
+			}
+		}
+	}
+
+	if (nodesExpanded)
+		*nodesExpanded = forward.expanded + backward.expanded;
+
+	if (!meetEdge)
+		return false;
+
+	// Stitch the two halves together across the meeting edge.
+	ZoneOrdinal meetDest = meetEdge->destination;
+	int meetIndex = forward.depth[meetSource];
+	outPath.resize(meetIndex + backward.depth[meetDest] + 2, ZonePathNode(0, -1, 0, nullptr));
+
+	auto makeNode = [&](ZoneOrdinal ordinal, const ZoneGraphEdge* edge)
+	{
+		return MakePathNode(m_nodes[ordinal].zoneId, edge);
+	};
+
+	ZoneOrdinal ordinal = meetSource;
+	const ZoneGraphEdge* edge = meetEdge;
+
+	for (int i = meetIndex; i >= 0; --i)
+	{
+		outPath[i] = makeNode(ordinal, edge);
+
+		edge = forward.prevEdge[ordinal];
+		ordinal = forward.prevNode[ordinal];
+	}
+
+	ordinal = meetDest;
+	for (int i = meetIndex + 1; i < (int)outPath.size(); ++i)
+	{
+		outPath[i] = makeNode(ordinal, backward.prevEdge[ordinal]);
+		ordinal = backward.prevNode[ordinal];
+	}
+
+	return true;
+}
+
+std::vector<ZoneGraphRoute> ZoneGraph::FindAlternativeRoutes(ZoneOrdinal from, ZoneOrdinal to,
+	ZonePathRoutingMode mode, const ZoneEdgeMask& edgeMask, int count) const
+{
+	std::vector<ZoneGraphRoute> routes;
+
+	int nodeCount = GetNodeCount();
+	if (from >= nodeCount || to >= nodeCount || from == to || count <= 0)
+		return routes;
+
+	auto routeCost = [&](const std::vector<uint32_t>& edges) -> uint32_t
+	{
+		if (mode == ZonePathRoutingMode::LowestLevel)
+		{
+			int level = m_nodes[from].minLevel;
+			for (uint32_t index : edges)
+				level = std::max(level, m_nodes[m_edges[index].destination].minLevel);
+
+			return MakeBottleneckKey(level, (int)edges.size());
+		}
+
+		uint32_t cost = 0;
+		for (uint32_t index : edges)
+			cost += mode == ZonePathRoutingMode::FewestZones ? 1 : m_edges[index].cost;
+
+		return cost;
+	};
+
+	// Searches from `source` to `to` and appends the edges of the route. Returns false if there is none.
+	auto searchEdges = [&](ZoneOrdinal source, const ZoneEdgeMask& mask, std::vector<uint32_t>& outEdges)
+	{
+		Search(source, to, mode, mask, s_searchState);
+		if (s_searchState.depth[to] == -1)
+			return false;
+
+		size_t start = outEdges.size();
+		outEdges.resize(start + s_searchState.depth[to]);
+
+		ZoneOrdinal ordinal = to;
+		for (size_t i = outEdges.size(); i-- > start;)
+		{
+			outEdges[i] = (uint32_t)(s_searchState.prevEdge[ordinal] - m_edges.data());
+			ordinal = s_searchState.prevNode[ordinal];
+		}
+
+		return true;
+	};
+
+	ZoneGraphRoute best;
+	if (!searchEdges(from, edgeMask, best.edges))
+		return routes;
+
+	best.cost = routeCost(best.edges);
+	routes.push_back(std::move(best));
+
+	std::vector<ZoneGraphRoute> candidates;
+	std::vector<ZoneOrdinal> rootNodes;
+
+	while ((int)routes.size() < count)
+	{
+		const std::vector<uint32_t> previous = routes.back().edges;
+
+		// Branch off the previous route at every zone along it.
+		rootNodes.clear();
+		ZoneOrdinal spurNode = from;
+
+		for (size_t i = 0; i < previous.size(); ++i)
+		{
+			ZoneEdgeMask mask = edgeMask;
+
+			// Don't take the same next step as any route that shares this root.
+			for (const ZoneGraphRoute& route : routes)
+			{
+				if (route.edges.size() > i && std::equal(previous.begin(), previous.begin() + i, route.edges.begin()))
+					mask.Set(route.edges[i], false);
+			}
+
+			// Keep the route loopless by not leaving any zone that is already on the root, and not
+			// teleporting back into one either.
+			for (ZoneOrdinal rootNode : rootNodes)
+			{
+				for (uint32_t index = m_edgeOffsets[rootNode]; index < m_edgeOffsets[rootNode + 1]; ++index)
+					mask.Set(index, false);
+			}
+
+			for (uint32_t index = m_edgeOffsets[nodeCount]; index < (uint32_t)m_edges.size(); ++index)
+			{
+				if (std::find(rootNodes.begin(), rootNodes.end(), m_edges[index].destination) != rootNodes.end())
+					mask.Set(index, false);
+			}
+
+			ZoneGraphRoute candidate;
+			candidate.edges.assign(previous.begin(), previous.begin() + i);
+
+			if (searchEdges(spurNode, mask, candidate.edges))
+			{
+				candidate.cost = routeCost(candidate.edges);
+
+				bool duplicate = std::any_of(candidates.begin(), candidates.end(),
+					[&](const ZoneGraphRoute& other) { return other.edges == candidate.edges; });
+
+				if (!duplicate)
+					candidates.push_back(std::move(candidate));
+			}
+
+			rootNodes.push_back(spurNode);
+			spurNode = m_edges[previous[i]].destination;
+		}
+
+		if (candidates.empty())
+			break;
+
+		// Take the cheapest candidate, preferring fewer zones on ties.
+		auto next = std::min_element(candidates.begin(), candidates.end(),
+			[](const ZoneGraphRoute& a, const ZoneGraphRoute& b)
+			{
+				return a.cost != b.cost ? a.cost < b.cost : a.edges.size() < b.edges.size();
+			});
+
+		routes.push_back(std::move(*next));
+		candidates.erase(next);
+	}
+
+	return routes;
+}
+
+void ZoneGraph::GetRoutePath(ZoneOrdinal from, const ZoneGraphRoute& route, std::vector<ZonePathNode>& outPath) const
+{
+	outPath.clear();
+	outPath.reserve(route.edges.size() + 1);
+
+	ZoneOrdinal current = from;
+	for (uint32_t index : route.edges)
+	{
+		const ZoneGraphEdge& edge = m_edges[index];
+
+		outPath.push_back(MakePathNode(m_nodes[current].zoneId, &edge));
+		current = edge.destination;
+	}
+
+	outPath.emplace_back(m_nodes[current].zoneId, -1, 0, nullptr);
+}
+
+void ZoneGraph::Search(ZoneOrdinal from, ZoneOrdinal to, ZonePathRoutingMode mode, const ZoneEdgeMask& edgeMask,
+	ZoneGraphSearchState& state) const
+{
+	switch (mode)
+	{
+	case ZonePathRoutingMode::FastestTravel:
+		DijkstraSearch(from, to, edgeMask, state);
+		break;
+
+	case ZonePathRoutingMode::LowestLevel:
+		BottleneckSearch(from, to, edgeMask, state);
+		break;
+
+	case ZonePathRoutingMode::FewestZones:
+	default:
+		BreadthFirstSearch(from, to, edgeMask, state);
+		break;
+	}
+}
+
+void ZoneGraph::BreadthFirstSearch(ZoneOrdinal from, ZoneOrdinal to, const ZoneEdgeMask& edgeMask,
+	ZoneGraphSearchState& state) const
+{
+	state.Reset(GetNodeCount());
+
+	state.depth[from] = 0;
+	state.pathMinLevel[from] = m_nodes[from].minLevel;
+	state.queue.push_back(from);
+
+	for (size_t head = 0; head < state.queue.size(); ++head)
+	{
+		ZoneOrdinal current = state.queue[head];
+		int currentDepth = state.depth[current];
+		int currentMinLevel = state.pathMinLevel[current];
+
+		// Did we find a connection to the destination?
+		if (to != InvalidZoneOrdinal && state.depth[to] > -1 && state.depth[to] < currentDepth)
+			break;
+
+		++state.expanded;
+
+		for (const ZoneGraphEdge* edge = FirstEdge(current); edge; edge = NextEdge(current, edge))
+		{
+			if (!IsEdgeEnabled(edge, edgeMask))
+				continue;
+
+			ZoneOrdinal dest = edge->destination;
+
+			if (state.depth[dest] == -1)
+			{
+				state.queue.push_back(dest);
+
+				state.depth[dest] = currentDepth + 1;
+				state.prevNode[dest] = current;
+				state.prevEdge[dest] = edge;
+				state.pathMinLevel[dest] = std::max(currentMinLevel, (int)edge->minLevel);
+			}
+			else if (state.prevNode[dest] != InvalidZoneOrdinal && state.depth[dest] == currentDepth + 1
+				&& state.pathMinLevel[state.prevNode[dest]] > currentMinLevel)
+			{
+				// lower level preference
+				state.prevNode[dest] = current;
+				state.prevEdge[dest] = edge;
+				state.pathMinLevel[dest] = std::max(currentMinLevel, (int)edge->minLevel);
+			}
+		}
+	}
+}
+
+void ZoneGraph::DijkstraSearch(ZoneOrdinal from, ZoneOrdinal to, const ZoneEdgeMask& edgeMask,
+	ZoneGraphSearchState& state) const
+{
+	state.Reset(GetNodeCount());
+
+	state.depth[from] = 0;
+	state.distance[from] = 0;
+	state.pathMinLevel[from] = m_nodes[from].minLevel;
+	state.heap.emplace_back(0, from);
+
+	while (!state.heap.empty())
+	{
+		std::pop_heap(state.heap.begin(), state.heap.end(), HeapCompare);
+		auto [currentDistance, current] = state.heap.back();
+		state.heap.pop_back();
+
+		// Skip entries that were superseded by a shorter route.
+		if (currentDistance > state.distance[current])
+			continue;
+
+		state.queue.push_back(current);
+
+		if (current == to)
+			break;
+
+		++state.expanded;
+
+		int currentMinLevel = state.pathMinLevel[current];
+
+		for (const ZoneGraphEdge* edge = FirstEdge(current); edge; edge = NextEdge(current, edge))
+		{
+			if (!IsEdgeEnabled(edge, edgeMask))
+				continue;
+
+			ZoneOrdinal dest = edge->destination;
+			uint32_t newDistance = currentDistance + edge->cost;
+
+			// Edge costs are at least 1, so a zone that was already settled can never be updated here.
+			if (newDistance < state.distance[dest]
+				|| (newDistance == state.distance[dest] && state.pathMinLevel[state.prevNode[dest]] > currentMinLevel))
+			{
+				if (newDistance < state.distance[dest])
+				{
+					state.distance[dest] = newDistance;
+					state.heap.emplace_back(newDistance, dest);
+					std::push_heap(state.heap.begin(), state.heap.end(), HeapCompare);
+				}
+
+				state.depth[dest] = state.depth[current] + 1;
+				state.prevNode[dest] = current;
+				state.prevEdge[dest] = edge;
+				state.pathMinLevel[dest] = std::max(currentMinLevel, (int)edge->minLevel);
+			}
+		}
+	}
+}
+
+void ZoneGraph::BottleneckSearch(ZoneOrdinal from, ZoneOrdinal to, const ZoneEdgeMask& edgeMask,
+	ZoneGraphSearchState& state) const
+{
+	state.Reset(GetNodeCount());
+
+	// pathMinLevel holds the highest zone level on the way to a zone and depth the number of zones.
+	// Zones are found in buckets by that level. distance marks the zones that have been settled.
+	state.levelBuckets.resize(m_maxZoneLevel + 1);
+	for (auto& bucket : state.levelBuckets)
+		bucket.clear();
+
+	state.depth[from] = 0;
+	state.pathMinLevel[from] = m_nodes[from].minLevel;
+	state.levelBuckets[m_nodes[from].minLevel].emplace_back(0, from);
+
+	for (int level = 0; level <= m_maxZoneLevel; ++level)
+	{
+		// Only lower levels add to this bucket, so it is complete by now. Zones that are found at this
+		// level come out in order of depth, so merging the two settles the zones in order.
+		auto& bucket = state.levelBuckets[level];
+		if (bucket.empty())
+			continue;
+
+		std::sort(bucket.begin(), bucket.end());
+		state.levelFrontier.clear();
+
+		size_t bucketIndex = 0;
+		size_t head = 0;
+
+		while (bucketIndex < bucket.size() || head < state.levelFrontier.size())
+		{
+			ZoneOrdinal current;
+			if (head < state.levelFrontier.size()
+				&& (bucketIndex == bucket.size() || state.depth[state.levelFrontier[head]] <= bucket[bucketIndex].first))
+			{
+				current = state.levelFrontier[head++];
+			}
+			else
+			{
+				current = bucket[bucketIndex++].second;
+			}
+
+			// Skip entries that were superseded by a better route.
+			if (state.distance[current] != UINT32_MAX)
+				continue;
+
+			state.distance[current] = level;
+			state.queue.push_back(current);
+
+			if (current == to)
+				return;
+
+			++state.expanded;
+
+			int currentDepth = state.depth[current];
+
+			for (const ZoneGraphEdge* edge = FirstEdge(current); edge; edge = NextEdge(current, edge))
+			{
+				if (!IsEdgeEnabled(edge, edgeMask))
+					continue;
+
+				ZoneOrdinal dest = edge->destination;
+				if (state.distance[dest] != UINT32_MAX)
+					continue;
+
+				int newLevel = std::max(level, m_nodes[dest].minLevel);
+				if (state.depth[dest] != -1 && (newLevel > state.pathMinLevel[dest]
+					|| (newLevel == state.pathMinLevel[dest] && currentDepth + 1 >= state.depth[dest])))
+				{
+					continue;
+				}
+
+				state.depth[dest] = currentDepth + 1;
+				state.pathMinLevel[dest] = newLevel;
+				state.prevNode[dest] = current;
+				state.prevEdge[dest] = edge;
+
+				if (newLevel == level)
+					state.levelFrontier.push_back(dest);
+				else
+					state.levelBuckets[newLevel].emplace_back(currentDepth + 1, dest);
+			}
+		}
+	}
+}
+
+bool ZoneGraph::ExtractPath(const ZoneGraphSearchState& state, ZoneOrdinal to, std::vector<ZonePathNode>& outPath) const
+{
+	outPath.clear();
+
+	if (state.depth[to] == -1)
+		return false;
+
+	// Work backwards from the destination and build the route. Each node carries the link
+	// that is used to leave it.
+	outPath.resize(state.depth[to] + 1, ZonePathNode(0, -1, 0, nullptr));
+
+	ZoneOrdinal ordinal = to;
+	const ZoneGraphEdge* edge = nullptr;
+
+	for (int i = state.depth[to]; i >= 0; --i)
+	{
+		outPath[i] = MakePathNode(m_nodes[ordinal].zoneId, edge);
+
+		edge = state.prevEdge[ordinal];
+		ordinal = state.prevNode[ordinal];
+	}
+
+	return true;
+}
+
+//============================================================================
+
+std::shared_ptr<const ZoneRoutingTable> ZoneRoutingTable::Build(std::shared_ptr<const ZoneGraph> graph,
+	ZonePathRoutingMode mode, std::shared_ptr<const ZoneEdgeMask> edgeMask)
+{
+	// Sources are handed out in small batches so that threads that get cheap searches keep taking more.
+	constexpr int SourcesPerBatch = 8;
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	auto table = std::make_shared<ZoneRoutingTable>();
+	int nodeCount = graph->GetNodeCount();
+
+	table->m_mode = mode;
+	table->m_nodeCount = nodeCount;
+	table->m_nextEdge.assign((size_t)nodeCount * nodeCount, NoRoute);
+	table->m_hops.assign((size_t)nodeCount * nodeCount, Unreachable);
+
+	// Leave a core for the game.
+	int threadCount = std::clamp((int)std::thread::hardware_concurrency() - 1, 1, std::max(nodeCount / SourcesPerBatch, 1));
+	std::atomic<int> nextSource = 0;
+
+	// Every source fills in its own row, so the workers never write to the same memory.
+	auto worker = [&]()
+	{
+		ZoneGraphSearchState state;
+
+		while (true)
+		{
+			int firstSource = nextSource.fetch_add(SourcesPerBatch);
+			if (firstSource >= nodeCount)
+				break;
+
+			int lastSource = std::min(firstSource + SourcesPerBatch, nodeCount);
+			for (int source = firstSource; source < lastSource; ++source)
+				table->BuildRow(*graph, (ZoneOrdinal)source, mode, *edgeMask, state);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount - 1);
+	for (int i = 1; i < threadCount; ++i)
+		threads.emplace_back(worker);
+
+	worker();
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	table->m_graph = std::move(graph);
+	table->m_threadCount = threadCount;
+	table->m_buildTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+	SPDLOG_DEBUG("Built zone routing table for {} zones in {:.2f} ms on {} threads", nodeCount,
+		table->m_buildTime, threadCount);
+
+	return table;
+}
+
+void ZoneRoutingTable::BuildRow(const ZoneGraph& graph, ZoneOrdinal source, ZonePathRoutingMode mode,
+	const ZoneEdgeMask& edgeMask, ZoneGraphSearchState& state)
+{
+	graph.Search(source, InvalidZoneOrdinal, mode, edgeMask, state);
+
+	uint32_t* nextEdge = &m_nextEdge[Index(source, 0)];
+	uint8_t* hops = &m_hops[Index(source, 0)];
+
+	// Zones come out of the queue in the order they were settled, so the first hop toward
+	// a zone's predecessor is always known by the time we get to it.
+	for (ZoneOrdinal ordinal : state.queue)
+	{
+		hops[ordinal] = (uint8_t)std::min(state.depth[ordinal], Unreachable - 1);
+
+		if (ordinal == source)
+			continue;
+
+		ZoneOrdinal prev = state.prevNode[ordinal];
+		nextEdge[ordinal] = prev == source ? graph.GetEdgeIndex(state.prevEdge[ordinal]) : nextEdge[prev];
+	}
+}
+
+const ZoneGraphEdge* ZoneRoutingTable::GetNextEdge(ZoneOrdinal from, ZoneOrdinal to) const
+{
+	uint32_t next = m_nextEdge[Index(from, to)];
+	if (next == NoRoute)
+		return nullptr;
+
+	return &m_graph->GetEdge(next);
+}
+
+bool ZoneRoutingTable::GetPath(ZoneOrdinal from, ZoneOrdinal to, std::vector<ZonePathNode>& outPath) const
+{
+	outPath.clear();
+
+	if (from >= m_nodeCount || to >= m_nodeCount)
+		return false;
+
+	int hops = GetHopCount(from, to);
+	if (hops <= 0)
+		return false;
+
+	outPath.reserve(hops + 1);
+
+	ZoneOrdinal current = from;
+	while (current != to)
+	{
+		const ZoneGraphEdge* edge = GetNextEdge(current, to);
+		if (!edge || (int)outPath.size() > hops)
+		{
+			outPath.clear();
+			return false;
+		}
+
+		outPath.push_back(ZoneGraph::MakePathNode(m_graph->GetNode(current).zoneId, edge));
+		current = edge->destination;
+	}
+
+	outPath.emplace_back(m_graph->GetNode(to).zoneId, -1, 0, nullptr);
+	return true;
+}
+
+//============================================================================
+
+std::shared_ptr<const ZoneReachability> ZoneReachability::Build(std::shared_ptr<const ZoneGraph> graph,
+	std::shared_ptr<const ZoneEdgeMask> edgeMask)
+{
+	if (!graph || !edgeMask)
+		return nullptr;
+
+	auto reachability = std::make_shared<ZoneReachability>();
+	reachability->m_graph = graph;
+	reachability->m_edgeMask = edgeMask;
+
+	int nodeCount = graph->GetNodeCount();
+	const ZoneEdgeMask& mask = *edgeMask;
+
+	// Tarjan's algorithm, with an explicit stack. Components are numbered as they are completed,
+	// so every component that a component can reach has a lower number than it does.
+	constexpr int Unvisited = -1;
+	std::vector<int> index(nodeCount, Unvisited);
+	std::vector<int> lowLink(nodeCount, 0);
+	std::vector<bool> onStack(nodeCount, false);
+	std::vector<ZoneOrdinal> stack;
+	std::vector<ZoneOrdinal> completed;                   // zones in the order their components completed
+	std::vector<std::pair<ZoneOrdinal, const ZoneGraphEdge*>> callStack;
+	int nextIndex = 0;
+
+	reachability->m_components.resize(nodeCount);
+	completed.reserve(nodeCount);
+
+	for (int root = 0; root < nodeCount; ++root)
+	{
+		if (index[root] != Unvisited)
+			continue;
+
+		auto visit = [&](ZoneOrdinal ordinal)
+		{
+			index[ordinal] = lowLink[ordinal] = nextIndex++;
+			stack.push_back(ordinal);
+			onStack[ordinal] = true;
+			callStack.emplace_back(ordinal, graph->FirstEdge(ordinal));
+		};
+
+		visit((ZoneOrdinal)root);
+
+		while (!callStack.empty())
+		{
+			auto& [current, edge] = callStack.back();
+
+			// Skip edges that can't be used.
+			while (edge && !mask.Test(graph->GetEdgeIndex(edge)))
+				edge = graph->NextEdge(current, edge);
+
+			if (edge)
+			{
+				ZoneOrdinal next = edge->destination;
+				edge = graph->NextEdge(current, edge);
+
+				if (index[next] == Unvisited)
+					visit(next);
+				else if (onStack[next])
+					lowLink[current] = std::min(lowLink[current], index[next]);
+
+				continue;
+			}
+
+			ZoneOrdinal finished = current;
+			callStack.pop_back();
+
+			if (!callStack.empty())
+				lowLink[callStack.back().first] = std::min(lowLink[callStack.back().first], lowLink[finished]);
+
+			if (lowLink[finished] == index[finished])
+			{
+				ZoneOrdinal member;
+				do
+				{
+					member = stack.back();
+					stack.pop_back();
+					onStack[member] = false;
+
+					reachability->m_components[member] = (uint16_t)reachability->m_componentCount;
+					completed.push_back(member);
+				} while (member != finished);
+
+				++reachability->m_componentCount;
+			}
+		}
+	}
+
+	// Every component reaches itself and whatever its successors reach. Successors were completed
+	// first, so their sets are already final.
+	size_t words = (reachability->m_componentCount + 63) / 64;
+	reachability->m_wordsPerComponent = words;
+	reachability->m_reach.assign(words * reachability->m_componentCount, 0);
+
+	for (ZoneOrdinal ordinal : completed)
+	{
+		uint32_t component = reachability->m_components[ordinal];
+		uint64_t* reach = &reachability->m_reach[component * words];
+		reach[component >> 6] |= 1ull << (component & 63);
+
+		for (const ZoneGraphEdge* edge = graph->FirstEdge(ordinal); edge; edge = graph->NextEdge(ordinal, edge))
+		{
+			uint32_t destination = reachability->m_components[edge->destination];
+			if (destination == component || !mask.Test(graph->GetEdgeIndex(edge)))
+				continue;
+
+			const uint64_t* destinationReach = &reachability->m_reach[destination * words];
+			for (size_t word = 0; word < words; ++word)
+				reach[word] |= destinationReach[word];
+		}
+	}
+
+	SPDLOG_DEBUG("Built zone reachability: {} zones in {} components", nodeCount, reachability->m_componentCount);
+
+	return reachability;
+}
+
+std::string ZoneReachability::DescribeBoundary(ZoneOrdinal from, ZoneOrdinal to) const
+{
+	const ZoneGraph& graph = *m_graph;
+	int nodeCount = graph.GetNodeCount();
+	int reachableCount = 0;
+
+	// The best explanation is a connection that would lead somewhere that can reach `to`.
+	std::string blocked;
+	bool blockedLeadsToTarget = false;
+
+	auto consider = [&](ZoneOrdinal source, ZoneOrdinal destination, std::string_view reason)
+	{
+		if (destination == InvalidZoneOrdinal || CanReach(from, destination) || blockedLeadsToTarget)
+			return;
+
+		bool leadsToTarget = CanReach(destination, to);
+		if (blocked.empty() || leadsToTarget)
+		{
+			blocked = fmt::format("{} -> {} ({})", GetFullZone(graph.GetNode(source).zoneId),
+				GetFullZone(graph.GetNode(destination).zoneId), reason);
+			blockedLeadsToTarget = leadsToTarget;
+		}
+	};
+
+	const ZoneGuideSnapshot& zoneGuide = graph.GetZoneGuide();
+
+	for (int i = 0; i < nodeCount; ++i)
+	{
+		ZoneOrdinal ordinal = (ZoneOrdinal)i;
+		if (!CanReach(from, ordinal))
+			continue;
+
+		++reachableCount;
+
+		// Connections that are in the graph but whose requirements aren't met.
+		for (const ZoneGraphEdge* edge = graph.EdgesBegin(ordinal); edge != graph.EdgesEnd(ordinal); ++edge)
+		{
+			if (m_edgeMask->Test(graph.GetEdgeIndex(edge)))
+				continue;
+
+			if (!edge->requiredAchievementName.empty())
+				consider(ordinal, edge->destination, fmt::format("requires achievement: {}", edge->requiredAchievementName));
+			else if (edge->connection)
+				consider(ordinal, edge->destination, fmt::format("requires expansion: {}",
+					GetHighestExpansionOwnedName((EQExpansionOwned)edge->connection->requiredExpansions)));
+			else
+				consider(ordinal, edge->destination, "requirements not met");
+		}
+
+		// Connections that were left out of the graph because their transfer type is disabled.
+		if (const ZoneGuideSnapshot::Zone* zone = zoneGuide.GetZone(graph.GetNode(ordinal).zoneId))
+		{
+			for (const ZoneGuideConnection& connection : zone->connections)
+			{
+				if (g_configuration->IsDisabledTransferType(connection.transferTypeIndex))
+				{
+					const char* transferType = (size_t)connection.transferTypeIndex < zoneGuide.transferTypes.size()
+						? zoneGuide.transferTypes[connection.transferTypeIndex].c_str() : "unknown";
+					consider(ordinal, graph.GetOrdinal(connection.destZoneId),
+						fmt::format("transfer type disabled: {}", transferType));
+				}
+			}
+		}
+	}
+
+	std::string message = fmt::format("{} can only reach {} of {} zones, and {} is not one of them.",
+		GetFullZone(graph.GetNode(from).zoneId), reachableCount - 1, nodeCount - 1, GetFullZone(graph.GetNode(to).zoneId));
+
+	if (!blocked.empty())
+		message += fmt::format(" Blocked at {}.", blocked);
+	else
+		message += " No connections lead out of them.";
+
+	return message;
+}
+
+//============================================================================
+
+void ZonePath_InvalidateGraph()
+{
+	// Drop the old graph right away. Routes through it may use connections that are about to change.
+	s_zoneGraph.reset();
+	s_zoneGraphDirty = true;
+	++s_zoneGraphGeneration;
+
+	s_routingTable.reset();
+	s_hierarchy.reset();
+	s_routingTableDirty = true;
+	++s_routingTableGeneration;
+
+	s_contraction.reset();
+	s_contractionMetric.reset();
+	s_contractionMetricMask.reset();
+	s_reachability.reset();
+
+	s_edgeMask.reset();
+	s_readyEdgeMask.reset();
+	s_readyEdgeMaskBase.reset();
+	ZonePath_ClearRouteCache();
+}
+
+std::shared_ptr<const ZoneGraph> ZonePath_GetGraph()
+{
+	// Only one graph is built at a time. If the data changes while one is in flight, it is thrown
+	// away when it finishes and the next one is started then.
+	if (s_zoneGraphDirty && !s_zoneGraphBuild.valid())
+	{
+		if (std::shared_ptr<const ZoneGraphSource> source = ZoneGraphSource::Capture(ZoneGuideSnapshot::Capture()))
+		{
+			s_zoneGraphDirty = false;
+			s_zoneGraphBuildGeneration = s_zoneGraphGeneration;
+			s_zoneGraphBuild = std::async(std::launch::async,
+				[source = std::move(source)]() { return ZoneGraph::Build(source); });
+		}
+	}
+
+	return s_zoneGraph;
+}
+
+bool ZonePath_IsGraphBuilding()
+{
+	return !s_zoneGraph && s_zoneGraphBuild.valid();
+}
+
+static void UpdateZoneGraph()
+{
+	if (s_zoneGraphBuild.valid()
+		&& s_zoneGraphBuild.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+	{
+		std::shared_ptr<const ZoneGraph> graph = s_zoneGraphBuild.get();
+		if (graph && s_zoneGraphBuildGeneration == s_zoneGraphGeneration)
+			s_zoneGraph = std::move(graph);
+	}
+
+	// Starts the next build if the data changed.
+	ZonePath_GetGraph();
+}
+
+std::shared_ptr<const ZoneGraph> ZonePath_FinishGraphBuild()
+{
+	ZonePath_GetGraph();
+
+	if (s_zoneGraphBuild.valid())
+		s_zoneGraphBuild.wait();
+
+	UpdateZoneGraph();
+	return s_zoneGraph;
+}
+
+std::shared_ptr<const ZoneEdgeMask> ZonePath_GetEdgeMask()
+{
+	if (!s_edgeMask)
+	{
+		if (std::shared_ptr<const ZoneGraph> graph = ZonePath_GetGraph())
+			s_edgeMask = std::make_shared<ZoneEdgeMask>(graph->EvaluateRequirements());
+	}
+
+	return s_edgeMask;
+}
+
+std::shared_ptr<const ZoneEdgeMask> ZonePath_GetReadyEdgeMask()
+{
+	std::shared_ptr<const ZoneGraph> graph = ZonePath_GetGraph();
+	std::shared_ptr<const ZoneEdgeMask> edgeMask = ZonePath_GetEdgeMask();
+	if (!graph || !edgeMask)
+		return edgeMask;
+
+	auto now = std::chrono::steady_clock::now();
+	if (s_readyEdgeMask && s_readyEdgeMaskBase == edgeMask && now < s_readyEdgeMaskExpiry)
+		return s_readyEdgeMask;
+
+	std::shared_ptr<ZoneEdgeMask> readyMask;
+
+	for (const ZoneGraphEdge* edge = graph->UniversalEdgesBegin(); edge != graph->UniversalEdgesEnd(); ++edge)
+	{
+		uint32_t index = graph->GetEdgeIndex(edge);
+		if (!edgeMask->Test(index))
+			continue;
+
+		const ParsedTeleport* teleport = g_zoneConnections ? g_zoneConnections->FindTeleport(edge->teleportName) : nullptr;
+		if (teleport && teleport->IsReady())
+			continue;
+
+		if (!readyMask)
+			readyMask = std::make_shared<ZoneEdgeMask>(*edgeMask);
+		readyMask->Set(index, false);
+	}
+
+	s_readyEdgeMask = readyMask ? std::move(readyMask) : edgeMask;
+	s_readyEdgeMaskBase = edgeMask;
+	s_readyEdgeMaskExpiry = now + std::chrono::seconds(1);
+
+	return s_readyEdgeMask;
+}
+
+std::shared_ptr<const ZoneRoutingTable> ZonePath_GetRoutingTable()
+{
+	return s_routingTable;
+}
+
+std::shared_ptr<const ZoneReachability> ZonePath_GetReachability()
+{
+	return s_reachability;
+}
+
+static void UpdateReachability()
+{
+	if (s_reachabilityBuild.valid()
+		&& s_reachabilityBuild.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+	{
+		std::shared_ptr<const ZoneReachability> reachability = s_reachabilityBuild.get();
+		if (reachability && reachability->GetGraph() == s_zoneGraph && reachability->GetEdgeMask() == s_edgeMask)
+			s_reachability = std::move(reachability);
+	}
+
+	if (!s_zoneGraph || !s_edgeMask || s_reachabilityBuild.valid())
+		return;
+
+	if (s_reachability && s_reachability->GetGraph() == s_zoneGraph && s_reachability->GetEdgeMask() == s_edgeMask)
+		return;
+
+	s_reachabilityBuild = std::async(std::launch::async,
+		[graph = s_zoneGraph, edgeMask = s_edgeMask]() { return ZoneReachability::Build(graph, edgeMask); });
+}
+
+std::shared_ptr<const ZoneHierarchy> ZonePath_GetHierarchy()
+{
+	return s_hierarchy;
+}
+
+std::shared_ptr<const ZoneContractionMetric> ZonePath_GetContractionMetric()
+{
+	return s_contractionMetric;
+}
+
+static void UpdateContraction()
+{
+	if (s_contractionBuild.valid()
+		&& s_contractionBuild.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+	{
+		std::shared_ptr<const ZoneContraction> contraction = s_contractionBuild.get();
+		if (contraction && contraction->GetGraph() == s_zoneGraph)
+			s_contraction = std::move(contraction);
+	}
+
+	if (s_contractionMetricBuild.valid()
+		&& s_contractionMetricBuild.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+	{
+		std::shared_ptr<const ZoneContractionMetric> metric = s_contractionMetricBuild.get();
+		if (metric && metric->GetContraction() == s_contraction && metric->GetEdgeMask() == s_edgeMask
+			&& metric->GetMode() == g_configuration->GetRoutingMode())
+		{
+			s_contractionMetric = std::move(metric);
+
+			// The contraction answers everything the hierarchy did.
+			s_hierarchy.reset();
+		}
+	}
+
+	if (!s_zoneGraph || s_contractionBuild.valid() || s_contractionMetricBuild.valid()
+		|| s_zoneGraph->UsesArrivalSearch(g_configuration->GetRoutingMode()))
+	{
+		return;
+	}
+
+	if (!s_contraction)
+	{
+		s_contractionBuild = std::async(std::launch::async,
+			[graph = s_zoneGraph]() { return ZoneContraction::Build(graph); });
+		return;
+	}
+
+	// Requirement changes only need the costs customized again.
+	if (s_edgeMask && s_edgeMask != s_contractionMetricMask)
+	{
+		s_contractionMetricMask = s_edgeMask;
+		s_contractionMetricBuild = std::async(std::launch::async,
+			[contraction = s_contraction, mode = g_configuration->GetRoutingMode(), edgeMask = s_edgeMask]()
+			{
+				return ZoneContractionMetric::Customize(contraction, mode, edgeMask);
+			});
+	}
+}
+
+void ZonePath_UpdateRoutingTable()
+{
+	// Pick up a finished table, unless the graph changed while it was being built. The table is built
+	// by a std::async task that hands out batches of source zones from an atomic counter, and published
+	// by moving it into s_routingTable here. This stands in for work stealing and an atomic shared_ptr
+	// swap: every reader of s_routingTable is on the game thread, and path jobs take their own copy of
+	// the pointer when they are queued, so a plain assignment from the pulse is enough.
+	if (s_routingTableBuild.valid()
+		&& s_routingTableBuild.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+	{
+		std::shared_ptr<const ZoneRoutingTable> table = s_routingTableBuild.get();
+		if (table && table->GetGraph() == s_zoneGraph && s_routingTableBuildGeneration == s_routingTableGeneration)
+			s_routingTable = std::move(table);
+	}
+
+	if (s_hierarchyBuild.valid()
+		&& s_hierarchyBuild.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+	{
+		std::shared_ptr<const ZoneHierarchy> hierarchy = s_hierarchyBuild.get();
+		if (hierarchy && hierarchy->GetGraph() == s_zoneGraph && s_routingTableBuildGeneration == s_routingTableGeneration
+			&& !s_contractionMetric)
+		{
+			s_hierarchy = std::move(hierarchy);
+		}
+	}
+
+	UpdateZoneGraph();
+	UpdateReachability();
+	UpdateContraction();
+
+	if (!s_routingTableDirty || s_routingTableBuild.valid() || s_hierarchyBuild.valid())
+		return;
+
+	std::shared_ptr<const ZoneGraph> graph = ZonePath_GetGraph();
+	std::shared_ptr<const ZoneEdgeMask> edgeMask = ZonePath_GetEdgeMask();
+	if (!graph || !edgeMask)
+		return;
+
+	s_routingTableDirty = false;
+	s_routingTableBuildGeneration = s_routingTableGeneration;
+
+	ZonePathRoutingMode mode = g_configuration->GetRoutingMode();
+	if (graph->UsesArrivalSearch(mode))
+		return;
+
+	if (mode == ZonePathRoutingMode::LowestLevel)
+	{
+		s_routingTableBuild = std::async(std::launch::async,
+			[graph, mode, edgeMask]()
+			{
+				return ZoneRoutingTable::Build(graph, mode, edgeMask);
+			});
+	}
+	else if (!s_contraction)
+	{
+		s_hierarchyBuild = std::async(std::launch::async,
+			[graph, mode, edgeMask]()
+			{
+				return ZoneHierarchy::Build(graph, mode, edgeMask);
+			});
+	}
+}
+
+uint64_t ZonePath_GetRequirementFingerprint()
+{
+	uint64_t hash = 14695981039346656037ull;
+	auto mix = [&hash](uint64_t value)
+	{
+		hash ^= value;
+		hash *= 1099511628211ull;
+	};
+
+	mix(g_zoneConnections ? g_zoneConnections->GetContentHash() : 0);
+	mix((uint64_t)g_configuration->GetRoutingMode());
+	mix(g_configuration->IsBidirectionalSearchEnabled());
+
+	ZoneGuideManagerClient& zoneMgr = ZoneGuideManagerClient::Instance();
+	for (int i = 0; i < zoneMgr.transferTypes.GetLength(); ++i)
+		mix(g_configuration->IsDisabledTransferType(i) ? i + 1 : 0);
+
+	if (pEverQuestInfo)
+	{
+		mix(pEverQuestInfo->bProgressionServer);
+		mix((uint64_t)pEverQuestInfo->ProgressionOpenExpansions);
+	}
+
+	if (pLocalPC)
+		mix((uint64_t)pLocalPC->ExpansionFlags);
+
+	mix(s_edgeMask ? s_edgeMask->Hash() : 0);
+
+	return hash;
+}
+
+void ZonePath_UpdateRequirements()
+{
+	// There is no notification for completing an achievement, so re-evaluate the mask every so
+	// often. Only the handful of gated edges are actually checked.
+	auto now = std::chrono::steady_clock::now();
+	if (now < s_nextRequirementsCheck || !s_zoneGraph || !s_edgeMask || !pLocalPC)
+		return;
+
+	s_nextRequirementsCheck = now + std::chrono::seconds(1);
+
+	// Moving the bind point changes where gate goes, which needs a new graph.
+	if (!s_zoneGraph->AreUniversalEdgesCurrent())
+	{
+		SPDLOG_DEBUG("Teleport destinations changed, rebuilding zone graph");
+		ZonePath_InvalidateGraph();
+		return;
+	}
+
+	ZoneEdgeMask edgeMask = s_zoneGraph->EvaluateRequirements();
+	if (edgeMask == *s_edgeMask)
+		return;
+
+	SPDLOG_DEBUG("Zone connection requirements changed, rebuilding routing table");
+	s_edgeMask = std::make_shared<ZoneEdgeMask>(std::move(edgeMask));
+	s_contractionMetric.reset();
+
+	s_routingTable.reset();
+	s_hierarchy.reset();
+	s_routingTableDirty = true;
+	++s_routingTableGeneration;
+}
+
+void ZonePath_Shutdown()
+{
+	ZonePath_StopPathWorker();
+
+	if (s_routingTableBuild.valid())
+		s_routingTableBuild.wait();
+
+	if (s_hierarchyBuild.valid())
+		s_hierarchyBuild.wait();
+
+	if (s_contractionBuild.valid())
+		s_contractionBuild.wait();
+
+	if (s_contractionMetricBuild.valid())
+		s_contractionMetricBuild.wait();
+
+	if (s_reachabilityBuild.valid())
+		s_reachabilityBuild.wait();
+
+	if (s_zoneGraphBuild.valid())
+		s_zoneGraphBuild.wait();
+
+	s_routingTableBuild = {};
+	s_routingTable.reset();
+	s_hierarchyBuild = {};
+	s_hierarchy.reset();
+	s_contractionBuild = {};
+	s_contraction.reset();
+	s_contractionMetricBuild = {};
+	s_contractionMetric.reset();
+	s_contractionMetricMask.reset();
+	s_reachabilityBuild = {};
+	s_reachability.reset();
+	s_edgeMask.reset();
+	s_readyEdgeMask.reset();
+	s_readyEdgeMaskBase.reset();
+	s_zoneGraphBuild = {};
+	s_zoneGraph.reset();
+	s_zoneGraphDirty = true;
+}
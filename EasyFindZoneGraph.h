@@ -0,0 +1,480 @@
+#pragma once
+
+#include "EasyFind.h"
+
+#include <memory>
+#include <vector>
+
+// Zone ids are sparse, so the graph refers to zones by a dense ordinal instead.
+using ZoneOrdinal = uint16_t;
+constexpr ZoneOrdinal InvalidZoneOrdinal = 0xffff;
+
+struct ZoneGraphNode
+{
+	EQZoneIndex zoneId = 0;
+	int minLevel = 0;
+	int maxLevel = 0;
+	int continentIndex = -1;
+};
+
+struct ZoneGraphEdge
+{
+	ZoneOrdinal destination = InvalidZoneOrdinal;
+	int16_t transferTypeIndex = -1;
+	int16_t minLevel = 0;                                 // level used for the lower level preference
+	uint32_t cost = 1;                                    // estimated travel time, always at least 1
+	uint32_t runCost = 0;                                 // average run to this edge's exit, included in cost
+
+	// Copied out of the location and teleport, since searches run on the path worker while a reload
+	// can free them. Teleports are looked up again by name when they are needed.
+	glm::vec3 exitPoint = { 0, 0, 0 };
+	bool hasExitPoint = false;
+	bool fixedCost = false;                               // cost was set in ZoneConnections.yaml, so no run is added
+	int zoneIdentifier = 0;
+	std::string teleportName;                             // empty unless this is a universal edge
+	EQExpansionOwned requiredExpansions = (EQExpansionOwned)0;
+	int requiredAchievement = 0;
+	std::string requiredAchievementName;
+
+	// zone guide connection this link came from, owned by the graph's zone guide snapshot
+	const ZoneGuideConnection* connection = nullptr;
+};
+
+// A known position inside a zone where a connection to or from another zone is.
+struct ZoneTravelPoint
+{
+	ZoneOrdinal zone = InvalidZoneOrdinal;                // the other zone
+	glm::vec3 position = { 0, 0, 0 };
+};
+
+// One bit per edge of a graph, set if the edge can be used by the current character. Requirements
+// are evaluated into a mask once, so that searches never have to look at game state.
+class ZoneEdgeMask
+{
+public:
+	ZoneEdgeMask() = default;
+	ZoneEdgeMask(size_t edgeCount, bool enabled)
+		: m_bits((edgeCount + 63) / 64, enabled ? ~0ull : 0ull)
+	{
+	}
+
+	bool Test(uint32_t index) const { return (m_bits[index >> 6] >> (index & 63)) & 1; }
+
+	void Set(uint32_t index, bool enabled)
+	{
+		if (enabled)
+			m_bits[index >> 6] |= 1ull << (index & 63);
+		else
+			m_bits[index >> 6] &= ~(1ull << (index & 63));
+	}
+
+	uint64_t Hash() const
+	{
+		uint64_t hash = 14695981039346656037ull;
+		for (uint64_t word : m_bits)
+		{
+			hash ^= word;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	bool operator==(const ZoneEdgeMask& other) const { return m_bits == other.m_bits; }
+	bool operator!=(const ZoneEdgeMask& other) const { return m_bits != other.m_bits; }
+
+private:
+	std::vector<uint64_t> m_bits;
+};
+
+// A route through the graph as the list of edges taken.
+struct ZoneGraphRoute
+{
+	std::vector<uint32_t> edges;
+	uint32_t cost = 0;                                    // zone count or travel time, by routing mode
+};
+
+// Scratch space for searches, reused between queries to avoid allocating.
+struct ZoneGraphSearchState
+{
+	std::vector<int> depth;
+	std::vector<uint32_t> distance;
+	std::vector<int> pathMinLevel;
+	std::vector<ZoneOrdinal> prevNode;
+	std::vector<const ZoneGraphEdge*> prevEdge;
+	std::vector<ZoneOrdinal> queue;                       // zones in the order they were settled
+	std::vector<std::pair<uint32_t, ZoneOrdinal>> heap;
+	std::vector<std::vector<std::pair<int, ZoneOrdinal>>> levelBuckets; // (depth, zone) by highest zone level
+	std::vector<ZoneOrdinal> levelFrontier;
+	int expanded = 0;                                     // number of zones whose edges were searched
+
+	void Reset(int nodeCount);
+};
+
+// The parts of the zone guide that a zone graph is built from. Captured from ZoneGuideManagerClient,
+// or loaded from a ZoneGuide.yaml dump so that the router can be measured against saved data.
+struct ZoneGuideSnapshot
+{
+	struct Zone
+	{
+		EQZoneIndex zoneId = 0;
+		int minLevel = 0;
+		int maxLevel = 0;
+		int continentIndex = -1;
+		std::vector<ZoneGuideConnection> connections;
+	};
+
+	std::vector<Zone> zones;
+	std::vector<int> zoneIndices;                         // indexed by zone id, -1 if not in the guide
+	std::vector<std::string> transferTypes;
+
+	const Zone* GetZone(EQZoneIndex zoneId) const
+	{
+		int index = (size_t)zoneId < zoneIndices.size() ? zoneIndices[zoneId] : -1;
+		return index != -1 ? &zones[index] : nullptr;
+	}
+
+	int FindTransferType(std::string_view name) const;
+
+	// Copies the zone guide out of ZoneGuideManagerClient. Returns null if it isn't loaded yet.
+	static std::shared_ptr<const ZoneGuideSnapshot> Capture();
+
+	// Reads a zone guide written by /travelto dump. Returns null if the file can't be read.
+	static std::shared_ptr<const ZoneGuideSnapshot> LoadDump(const std::string& fileName);
+
+	void AddZone(Zone&& zone);
+};
+
+// Everything a zone graph needs from the zone connections and settings, copied on the game thread
+// so that the graph itself can be built on another thread.
+struct ZoneGraphSource
+{
+	struct Connection
+	{
+		EQZoneIndex fromZoneId = 0;                       // 0 for teleports, which work from anywhere
+		EQZoneIndex toZoneId = 0;
+		bool gated = false;                               // has requirements that the edge mask checks
+		ZoneGraphEdge edge;                               // everything but the destination
+	};
+
+	std::shared_ptr<const ZoneGuideSnapshot> zoneGuide;
+	std::vector<EQZoneIndex> zoneIds;                     // zones with an entry in the zone connections
+	std::vector<Connection> connections;                  // in the order they are visited for each zone
+	std::vector<Connection> teleports;
+
+	// Walks the zone guide and the zone connections. Must be called on the game thread. Returns null
+	// if zone data isn't available yet.
+	static std::shared_ptr<const ZoneGraphSource> Capture(std::shared_ptr<const ZoneGuideSnapshot> zoneGuide);
+};
+
+// The zone guide merged with our ZoneConnections.yaml edges, stored in compressed sparse row
+// form: the edges leaving a zone are m_edges[m_edgeOffsets[ordinal], m_edgeOffsets[ordinal + 1]).
+// Teleports that work from anywhere are stored once after the last zone's edges, and searches
+// treat them as leaving every zone.
+// A graph is immutable once built. It is rebuilt whenever the zone guide, the zone connections
+// or the transfer type settings change.
+class ZoneGraph
+{
+public:
+	// Builds a graph from the current game data. Returns null if zone data isn't available yet.
+	static std::shared_ptr<const ZoneGraph> Build();
+
+	// Builds a graph from a zone guide snapshot and the current zone connections.
+	static std::shared_ptr<const ZoneGraph> Build(std::shared_ptr<const ZoneGuideSnapshot> zoneGuide);
+
+	// Builds a graph from data that was already captured. Doesn't touch game state, so it can run on
+	// any thread.
+	static std::shared_ptr<const ZoneGraph> Build(std::shared_ptr<const ZoneGraphSource> source);
+
+	const ZoneGuideSnapshot& GetZoneGuide() const { return *m_zoneGuide; }
+
+	int GetNodeCount() const { return (int)m_nodes.size(); }
+	int GetEdgeCount() const { return (int)m_edges.size(); }
+
+	ZoneOrdinal GetOrdinal(EQZoneIndex zoneId) const
+	{
+		return (size_t)zoneId < m_ordinals.size() ? m_ordinals[zoneId] : InvalidZoneOrdinal;
+	}
+
+	const ZoneGraphNode& GetNode(ZoneOrdinal ordinal) const { return m_nodes[ordinal]; }
+
+	const ZoneGraphEdge* EdgesBegin(ZoneOrdinal ordinal) const { return m_edges.data() + m_edgeOffsets[ordinal]; }
+	const ZoneGraphEdge* EdgesEnd(ZoneOrdinal ordinal) const { return m_edges.data() + m_edgeOffsets[ordinal + 1]; }
+
+	// Edges arriving at a zone, as indices into the edge array.
+	const uint32_t* ReverseEdgesBegin(ZoneOrdinal ordinal) const { return m_reverseEdges.data() + m_reverseOffsets[ordinal]; }
+	const uint32_t* ReverseEdgesEnd(ZoneOrdinal ordinal) const { return m_reverseEdges.data() + m_reverseOffsets[ordinal + 1]; }
+
+	// Steps through the edges leaving a zone followed by the universal edges. Returns null at the end.
+	const ZoneGraphEdge* FirstEdge(ZoneOrdinal ordinal) const
+	{
+		return NextEdge(ordinal, m_edges.data() + m_edgeOffsets[ordinal] - 1);
+	}
+
+	const ZoneGraphEdge* NextEdge(ZoneOrdinal ordinal, const ZoneGraphEdge* edge) const
+	{
+		++edge;
+		if (edge == EdgesEnd(ordinal))
+			edge = UniversalEdgesBegin();
+
+		return edge != m_edges.data() + m_edges.size() ? edge : nullptr;
+	}
+
+	const ZoneGraphEdge* UniversalEdgesBegin() const { return m_edges.data() + m_edgeOffsets[m_nodes.size()]; }
+	const ZoneGraphEdge* UniversalEdgesEnd() const { return m_edges.data() + m_edges.size(); }
+
+	// Returns true if any universal edge is enabled in the mask.
+	bool HasUniversalEdges(const ZoneEdgeMask& edgeMask) const;
+
+	// Returns true if the universal edges still go where they went when the graph was built.
+	bool AreUniversalEdgesCurrent() const;
+
+	// Positions where you arrive in a zone, by the zone you came from. Only zones with connection
+	// coordinates in ZoneConnections.yaml have any.
+	const ZoneTravelPoint* EntryPointsBegin(ZoneOrdinal ordinal) const { return m_entryPoints.data() + m_entryOffsets[ordinal]; }
+	const ZoneTravelPoint* EntryPointsEnd(ZoneOrdinal ordinal) const { return m_entryPoints.data() + m_entryOffsets[ordinal + 1]; }
+
+	// Returns where you arrive in `ordinal` when coming from `from`, or null if it isn't known.
+	const glm::vec3* FindEntryPoint(ZoneOrdinal ordinal, ZoneOrdinal from) const;
+
+	// Returns true if the graph knows where some connections land, so that FindPathByArrival can do better
+	// than the average run across each zone.
+	bool HasArrivalPoints() const { return !m_arrivalCosts.empty(); }
+
+	// Returns true if routes in this mode come from FindPathByArrival. The routing table, hierarchy and
+	// contraction only know the average run across each zone, so none of them are used or built then.
+	bool UsesArrivalSearch(ZonePathRoutingMode mode) const
+	{
+		return mode == ZonePathRoutingMode::FastestTravel && HasArrivalPoints();
+	}
+
+	// Returns where an edge is taken from inside its zone, or null if it isn't known.
+	static const glm::vec3* GetExitPoint(const ZoneGraphEdge& edge);
+
+	// Cost of running in a straight line between two points in a zone, in the same units as edge costs.
+	static uint32_t GetRunCost(const glm::vec3& from, const glm::vec3& to);
+
+	// Cost of an edge when starting from `position` in its zone, instead of the average run.
+	static uint32_t GetCostFrom(const glm::vec3* position, const ZoneGraphEdge& edge);
+
+	const ZoneGraphEdge& GetEdge(uint32_t index) const { return m_edges[index]; }
+	uint32_t GetEdgeIndex(const ZoneGraphEdge* edge) const { return (uint32_t)(edge - m_edges.data()); }
+	ZoneOrdinal GetEdgeSource(uint32_t index) const { return m_edgeSources[index]; }
+
+	// Checks the expansion and achievement requirements of every edge against the current character.
+	// Universal edges are always enabled, see ZonePath_GetReadyEdgeMask.
+	ZoneEdgeMask EvaluateRequirements() const;
+
+	// Finds the best route according to the routing mode. Among routes that are equally good,
+	// prefers the one through lower level zones. Returns false if there is no route.
+	bool FindPath(ZoneOrdinal from, ZoneOrdinal to, ZonePathRoutingMode mode, const ZoneEdgeMask& edgeMask,
+		std::vector<ZonePathNode>& outPath, int* nodesExpanded = nullptr) const;
+
+	// Finds the fastest route over (zone, arrival point) states: the cost of leaving a zone includes
+	// the run from wherever the previous connection landed, or from startPosition in the first zone.
+	// This picks between zone lines into the same zone by where they lead, over the whole route.
+	bool FindPathByArrival(ZoneOrdinal from, ZoneOrdinal to, const ZoneEdgeMask& edgeMask, const glm::vec3* startPosition,
+		std::vector<ZonePathNode>& outPath, int* nodesExpanded = nullptr) const;
+
+	// Finds an equally good route by searching forward from `from` and backward from `to` until the
+	// two searches meet. Expands far fewer zones on long routes, but doesn't apply the lower level
+	// preference between equally good routes. Falls back to FindPath while universal edges are usable,
+	// since they arrive from every zone.
+	bool FindPathBidirectional(ZoneOrdinal from, ZoneOrdinal to, ZonePathRoutingMode mode,
+		const ZoneEdgeMask& edgeMask, std::vector<ZonePathNode>& outPath, int* nodesExpanded = nullptr) const;
+
+	// Finds the best route from `from` to whichever zone in `targets` is closest. Returns the zone
+	// that was reached, or InvalidZoneOrdinal if none of them can be reached.
+	ZoneOrdinal FindPathToNearest(ZoneOrdinal from, const std::vector<ZoneOrdinal>& targets, ZonePathRoutingMode mode,
+		const ZoneEdgeMask& edgeMask, std::vector<ZonePathNode>& outPath, int* nodesExpanded = nullptr) const;
+
+	// Finds up to `count` loopless routes from `from` to `to` in order of cost, using Yen's algorithm.
+	// The first route is the best one.
+	std::vector<ZoneGraphRoute> FindAlternativeRoutes(ZoneOrdinal from, ZoneOrdinal to, ZonePathRoutingMode mode,
+		const ZoneEdgeMask& edgeMask, int count) const;
+
+	// Converts a route into path nodes, starting at `from`.
+	void GetRoutePath(ZoneOrdinal from, const ZoneGraphRoute& route, std::vector<ZonePathNode>& outPath) const;
+
+	// Runs the search for the routing mode from `from` until `to` is settled, or over the whole graph
+	// if `to` is InvalidZoneOrdinal. Only edges set in edgeMask are used.
+	void Search(ZoneOrdinal from, ZoneOrdinal to, ZonePathRoutingMode mode, const ZoneEdgeMask& edgeMask,
+		ZoneGraphSearchState& state) const;
+
+	// Breadth-first search, minimizing the number of zone transfers.
+	void BreadthFirstSearch(ZoneOrdinal from, ZoneOrdinal to, const ZoneEdgeMask& edgeMask,
+		ZoneGraphSearchState& state) const;
+
+	// Dijkstra's algorithm over a binary heap, minimizing the total edge cost.
+	void DijkstraSearch(ZoneOrdinal from, ZoneOrdinal to, const ZoneEdgeMask& edgeMask,
+		ZoneGraphSearchState& state) const;
+
+	// Bottleneck search, minimizing the highest zone level on the route and then the number of zone
+	// transfers. Uses a bucket per zone level, so it runs in about the time of a breadth-first search.
+	void BottleneckSearch(ZoneOrdinal from, ZoneOrdinal to, const ZoneEdgeMask& edgeMask,
+		ZoneGraphSearchState& state) const;
+
+	static ZonePathNode MakePathNode(EQZoneIndex zoneId, const ZoneGraphEdge* edge);
+
+	// Builds the route to `to` out of a completed search.
+	bool ExtractPath(const ZoneGraphSearchState& state, ZoneOrdinal to, std::vector<ZonePathNode>& outPath) const;
+
+private:
+	bool IsEdgeEnabled(const ZoneGraphEdge* edge, const ZoneEdgeMask& edgeMask) const
+	{
+		return edgeMask.Test((uint32_t)(edge - m_edges.data()));
+	}
+
+	std::shared_ptr<const ZoneGuideSnapshot> m_zoneGuide;  // owns the connections that edges point to
+	std::vector<ZoneGraphNode> m_nodes;
+	std::vector<uint32_t> m_edgeOffsets;
+	std::vector<ZoneGraphEdge> m_edges;
+	std::vector<ZoneOrdinal> m_edgeSources;               // zone each edge leaves from
+	std::vector<uint32_t> m_reverseOffsets;
+	std::vector<uint32_t> m_reverseEdges;
+	std::vector<uint32_t> m_gatedEdges;                   // edges that have requirements to evaluate
+	std::vector<uint32_t> m_entryOffsets;
+	std::vector<ZoneTravelPoint> m_entryPoints;
+
+	// For each zone edge whose landing point is known, the cost of every edge leaving its destination
+	// when starting from there, stored at m_arrivalCosts[m_arrivalCostOffsets[edge]].
+	std::vector<uint32_t> m_arrivalCostOffsets;
+	std::vector<uint32_t> m_arrivalCosts;
+	std::vector<ZoneOrdinal> m_ordinals;                  // indexed by zone id
+	int m_maxZoneLevel = 0;
+};
+
+// Next hop for every pair of zones in a graph. Entries are the index of the edge to take in the graph's
+// edge array, which may be a universal edge, so a route is read by walking the table one zone at a time.
+class ZoneRoutingTable
+{
+public:
+	static constexpr uint32_t NoRoute = 0xffffffff;
+	static constexpr uint8_t Unreachable = 0xff;
+
+	// Runs a search from every zone, spread across a pool of worker threads. This is safe to run
+	// off the game thread.
+	static std::shared_ptr<const ZoneRoutingTable> Build(std::shared_ptr<const ZoneGraph> graph,
+		ZonePathRoutingMode mode, std::shared_ptr<const ZoneEdgeMask> edgeMask);
+
+	const std::shared_ptr<const ZoneGraph>& GetGraph() const { return m_graph; }
+	ZonePathRoutingMode GetMode() const { return m_mode; }
+
+	double GetBuildTime() const { return m_buildTime; }      // milliseconds
+	int GetBuildThreadCount() const { return m_threadCount; }
+	size_t GetMemoryUsage() const { return sizeof(*this) + m_nextEdge.capacity() * sizeof(uint32_t) + m_hops.capacity(); }
+
+	// Returns the number of zone transfers from `from` to `to`, or -1 if there is no route.
+	int GetHopCount(ZoneOrdinal from, ZoneOrdinal to) const
+	{
+		uint8_t hops = m_hops[Index(from, to)];
+		return hops == Unreachable ? -1 : hops;
+	}
+
+	// Returns the hop count to every zone from `from`, indexed by ordinal.
+	const uint8_t* GetHopCounts(ZoneOrdinal from) const { return &m_hops[Index(from, 0)]; }
+
+	const ZoneGraphEdge* GetNextEdge(ZoneOrdinal from, ZoneOrdinal to) const;
+
+	bool GetPath(ZoneOrdinal from, ZoneOrdinal to, std::vector<ZonePathNode>& outPath) const;
+
+private:
+	size_t Index(ZoneOrdinal from, ZoneOrdinal to) const { return (size_t)from * m_nodeCount + to; }
+
+	// Fills in the row for `source`. Rows don't overlap, so they can be built from different threads.
+	void BuildRow(const ZoneGraph& graph, ZoneOrdinal source, ZonePathRoutingMode mode,
+		const ZoneEdgeMask& edgeMask, ZoneGraphSearchState& state);
+
+	std::shared_ptr<const ZoneGraph> m_graph;
+	ZonePathRoutingMode m_mode = ZonePathRoutingMode::FewestZones;
+	int m_nodeCount = 0;
+	std::vector<uint32_t> m_nextEdge;
+	std::vector<uint8_t> m_hops;
+	double m_buildTime = 0;
+	int m_threadCount = 1;
+};
+
+// Strongly connected components of the usable part of a graph, with the set of components that
+// each one can reach. Answers whether any route exists without searching.
+class ZoneReachability
+{
+public:
+	static std::shared_ptr<const ZoneReachability> Build(std::shared_ptr<const ZoneGraph> graph,
+		std::shared_ptr<const ZoneEdgeMask> edgeMask);
+
+	const std::shared_ptr<const ZoneGraph>& GetGraph() const { return m_graph; }
+	const std::shared_ptr<const ZoneEdgeMask>& GetEdgeMask() const { return m_edgeMask; }
+
+	int GetComponentCount() const { return m_componentCount; }
+	int GetComponent(ZoneOrdinal ordinal) const { return m_components[ordinal]; }
+
+	bool CanReach(ZoneOrdinal from, ZoneOrdinal to) const
+	{
+		uint32_t component = m_components[to];
+		return (m_reach[m_components[from] * m_wordsPerComponent + (component >> 6)] >> (component & 63)) & 1;
+	}
+
+	// Explains why `to` can't be reached from `from`, naming an unusable connection that leaves the
+	// zones `from` can reach. Looks at the current configuration, so only call it from the game thread.
+	std::string DescribeBoundary(ZoneOrdinal from, ZoneOrdinal to) const;
+
+private:
+	std::shared_ptr<const ZoneGraph> m_graph;
+	std::shared_ptr<const ZoneEdgeMask> m_edgeMask;
+	std::vector<uint16_t> m_components;                   // component by ordinal
+	int m_componentCount = 0;
+	size_t m_wordsPerComponent = 0;
+	std::vector<uint64_t> m_reach;                        // bit set of reachable components, per component
+};
+
+int FindTransferIndexByName(std::string_view name);
+
+// Returns the current zone graph. If it was invalidated, starts building a new one in the background
+// and returns null until the pulse picks it up.
+std::shared_ptr<const ZoneGraph> ZonePath_GetGraph();
+
+// Returns true if there is no zone graph yet but one is being built.
+bool ZonePath_IsGraphBuilding();
+
+// Waits for a zone graph being built and publishes it. For the benchmark, which can't wait for the pulse.
+std::shared_ptr<const ZoneGraph> ZonePath_FinishGraphBuild();
+
+// Returns which edges of the current zone graph this character meets the requirements for. This
+// doesn't change often, so routing data is built for it. May return null.
+std::shared_ptr<const ZoneEdgeMask> ZonePath_GetEdgeMask();
+
+// Returns the edge mask with the teleports that aren't ready right now turned off, or the edge mask
+// itself if they all are. Checks cooldowns and casters, so only call it from the game thread.
+std::shared_ptr<const ZoneEdgeMask> ZonePath_GetReadyEdgeMask();
+
+// Returns the routing table for the current zone graph. It is only built for Lowest Level Zones
+// routing, and is null until the background build finishes.
+std::shared_ptr<const ZoneRoutingTable> ZonePath_GetRoutingTable();
+
+// Returns the reachability index. It is built in the background and may be for an older edge mask
+// than ZonePath_GetEdgeMask, so check that before using it. May return null.
+std::shared_ptr<const ZoneReachability> ZonePath_GetReachability();
+
+// Starts building the zone graph and the routing data when needed, and picks up finished builds.
+// Called from the pulse.
+void ZonePath_UpdateRoutingTable();
+
+// Identifies everything that decides which connections are usable: the loaded zone connections,
+// disabled transfer types, expansions, achievements and the routing mode. Routes generated under
+// the same fingerprint are always the same.
+uint64_t ZonePath_GetRequirementFingerprint();
+
+// Re-evaluates the edge mask every so often, and rebuilds routing data when it changes.
+void ZonePath_UpdateRequirements();
+
+struct ZoneRouteCacheStats
+{
+	uint32_t hits = 0;
+	uint32_t misses = 0;
+	uint32_t entries = 0;
+};
+
+ZoneRouteCacheStats ZonePath_GetRouteCacheStats();
+void ZonePath_ClearRouteCache();
+
+// Stops the thread that runs asynchronous path requests, dropping any that haven't finished.
+void ZonePath_StopPathWorker();
@@ -0,0 +1,348 @@
+
+#include "EasyFind.h"
+#include "EasyFindZoneHierarchy.h"
+
+#include <chrono>
+
+static thread_local std::vector<uint32_t> s_overlayDistance;
+static thread_local std::vector<uint32_t> s_overlayPrevEdge;
+static thread_local std::vector<uint32_t> s_overlayPrevGateway;
+static thread_local std::vector<std::pair<uint32_t, uint32_t>> s_overlayHeap;
+
+// std heap functions build a max heap, so order by greater to pop the closest entry first.
+template <typename T>
+static bool HeapCompare(const std::pair<uint32_t, T>& a, const std::pair<uint32_t, T>& b)
+{
+	return a.first > b.first;
+}
+
+std::shared_ptr<const ZoneHierarchy> ZoneHierarchy::Build(std::shared_ptr<const ZoneGraph> graph,
+	ZonePathRoutingMode mode, std::shared_ptr<const ZoneEdgeMask> edgeMask)
+{
+	// The bottleneck cost of a route can't be added up from the overlay.
+	if (!graph || !edgeMask || mode == ZonePathRoutingMode::LowestLevel)
+		return nullptr;
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	auto hierarchy = std::make_shared<ZoneHierarchy>();
+	hierarchy->m_graph = graph;
+	hierarchy->m_edgeMask = edgeMask;
+	hierarchy->m_mode = mode;
+
+	int nodeCount = graph->GetNodeCount();
+
+	// Number the continents densely. Zones without continent data end up together on one of their own,
+	// which doesn't change the routes that are found.
+	std::vector<int> continentIds;
+	hierarchy->m_continents.resize(nodeCount);
+
+	for (int i = 0; i < nodeCount; ++i)
+	{
+		int continentIndex = graph->GetNode((ZoneOrdinal)i).continentIndex;
+
+		auto iter = std::find(continentIds.begin(), continentIds.end(), continentIndex);
+		if (iter == continentIds.end())
+			iter = continentIds.insert(continentIds.end(), continentIndex);
+
+		hierarchy->m_continents[i] = (int)(iter - continentIds.begin());
+	}
+
+	if (continentIds.size() < 2)
+		return nullptr;
+
+	hierarchy->m_continentGateways.resize(continentIds.size());
+	hierarchy->m_gatewayIndices.assign(nodeCount, -1);
+
+	auto addGateway = [&](ZoneOrdinal ordinal)
+	{
+		if (hierarchy->m_gatewayIndices[ordinal] != -1)
+			return;
+
+		hierarchy->m_gatewayIndices[ordinal] = (int)hierarchy->m_gateways.size();
+		hierarchy->m_continentGateways[hierarchy->m_continents[ordinal]].push_back((uint32_t)hierarchy->m_gateways.size());
+		hierarchy->m_gateways.push_back(ordinal);
+	};
+
+	for (int i = 0; i < nodeCount; ++i)
+	{
+		for (const ZoneGraphEdge* edge = graph->EdgesBegin((ZoneOrdinal)i); edge != graph->EdgesEnd((ZoneOrdinal)i); ++edge)
+		{
+			if (edgeMask->Test(graph->GetEdgeIndex(edge))
+				&& hierarchy->m_continents[i] != hierarchy->m_continents[edge->destination])
+			{
+				addGateway((ZoneOrdinal)i);
+				addGateway(edge->destination);
+			}
+		}
+	}
+
+	// Overlay edges leaving each gateway: routes to the other gateways on its continent, and its
+	// connections to other continents.
+	LocalSearchState state;
+	int gatewayCount = hierarchy->GetGatewayCount();
+	hierarchy->m_overlayOffsets.resize(gatewayCount + 1);
+
+	for (int gateway = 0; gateway < gatewayCount; ++gateway)
+	{
+		hierarchy->m_overlayOffsets[gateway] = (uint32_t)hierarchy->m_overlayEdges.size();
+
+		ZoneOrdinal ordinal = hierarchy->m_gateways[gateway];
+		int continent = hierarchy->m_continents[ordinal];
+
+		hierarchy->LocalSearch(ordinal, InvalidZoneOrdinal, false, state);
+
+		for (uint32_t other : hierarchy->m_continentGateways[continent])
+		{
+			uint32_t distance = state.distance[hierarchy->m_gateways[other]];
+			if (other != (uint32_t)gateway && distance != UINT32_MAX)
+				hierarchy->m_overlayEdges.push_back({ other, distance, NoEdge });
+		}
+
+		for (const ZoneGraphEdge* edge = graph->EdgesBegin(ordinal); edge != graph->EdgesEnd(ordinal); ++edge)
+		{
+			uint32_t index = graph->GetEdgeIndex(edge);
+
+			if (edgeMask->Test(index) && hierarchy->m_continents[edge->destination] != continent)
+			{
+				hierarchy->m_overlayEdges.push_back(
+					{ (uint32_t)hierarchy->m_gatewayIndices[edge->destination], hierarchy->EdgeCost(index), index });
+			}
+		}
+	}
+
+	hierarchy->m_overlayOffsets[gatewayCount] = (uint32_t)hierarchy->m_overlayEdges.size();
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+	SPDLOG_DEBUG("Built zone hierarchy: {} continents, {} gateways, {} overlay edges in {:.2f} ms",
+		hierarchy->GetContinentCount(), gatewayCount, hierarchy->GetOverlayEdgeCount(), elapsed.count());
+
+	return hierarchy;
+}
+
+size_t ZoneHierarchy::GetMemoryUsage() const
+{
+	size_t size = sizeof(*this);
+	size += m_continents.capacity() * sizeof(int);
+	size += m_gatewayIndices.capacity() * sizeof(int);
+	size += m_gateways.capacity() * sizeof(ZoneOrdinal);
+	size += m_overlayOffsets.capacity() * sizeof(uint32_t);
+	size += m_overlayEdges.capacity() * sizeof(OverlayEdge);
+
+	for (const auto& gateways : m_continentGateways)
+		size += sizeof(gateways) + gateways.capacity() * sizeof(uint32_t);
+
+	return size;
+}
+
+uint32_t ZoneHierarchy::EdgeCost(uint32_t edge) const
+{
+	return m_mode == ZonePathRoutingMode::FewestZones ? 1 : m_graph->GetEdge(edge).cost;
+}
+
+void ZoneHierarchy::LocalSearch(ZoneOrdinal from, ZoneOrdinal to, bool reverse, LocalSearchState& state) const
+{
+	int nodeCount = m_graph->GetNodeCount();
+	state.distance.assign(nodeCount, UINT32_MAX);
+	state.prevEdge.assign(nodeCount, NoEdge);
+	state.heap.clear();
+	state.expanded = 0;
+
+	int continent = m_continents[from];
+
+	state.distance[from] = 0;
+	state.heap.emplace_back(0, from);
+
+	while (!state.heap.empty())
+	{
+		std::pop_heap(state.heap.begin(), state.heap.end(), HeapCompare<ZoneOrdinal>);
+		auto [currentDistance, current] = state.heap.back();
+		state.heap.pop_back();
+
+		if (currentDistance > state.distance[current])
+			continue;
+
+		if (current == to)
+			break;
+
+		++state.expanded;
+
+		auto relax = [&](uint32_t index, ZoneOrdinal next)
+		{
+			if (!m_edgeMask->Test(index) || m_continents[next] != continent)
+				return;
+
+			uint32_t newDistance = currentDistance + EdgeCost(index);
+			if (newDistance < state.distance[next])
+			{
+				state.distance[next] = newDistance;
+				state.prevEdge[next] = index;
+				state.heap.emplace_back(newDistance, next);
+				std::push_heap(state.heap.begin(), state.heap.end(), HeapCompare<ZoneOrdinal>);
+			}
+		};
+
+		if (reverse)
+		{
+			for (const uint32_t* index = m_graph->ReverseEdgesBegin(current); index != m_graph->ReverseEdgesEnd(current); ++index)
+				relax(*index, m_graph->GetEdgeSource(*index));
+		}
+		else
+		{
+			for (const ZoneGraphEdge* edge = m_graph->EdgesBegin(current); edge != m_graph->EdgesEnd(current); ++edge)
+				relax(m_graph->GetEdgeIndex(edge), edge->destination);
+		}
+	}
+}
+
+void ZoneHierarchy::AppendLocalRoute(ZoneOrdinal from, ZoneOrdinal to, std::vector<uint32_t>& outEdges) const
+{
+	static thread_local LocalSearchState s_state;
+	LocalSearch(from, to, false, s_state);
+
+	size_t start = outEdges.size();
+	for (ZoneOrdinal current = to; current != from; current = m_graph->GetEdgeSource(s_state.prevEdge[current]))
+		outEdges.push_back(s_state.prevEdge[current]);
+
+	std::reverse(outEdges.begin() + start, outEdges.end());
+}
+
+bool ZoneHierarchy::FindPath(ZoneOrdinal from, ZoneOrdinal to, std::vector<ZonePathNode>& outPath, int* nodesExpanded) const
+{
+	static thread_local LocalSearchState s_forward;
+	static thread_local LocalSearchState s_backward;
+
+	outPath.clear();
+
+	int nodeCount = m_graph->GetNodeCount();
+	if (from >= nodeCount || to >= nodeCount || from == to || m_graph->HasUniversalEdges(*m_edgeMask))
+		return false;
+
+	// Distances from the start to every zone on its continent, and from every zone on the
+	// destination's continent to the destination.
+	LocalSearch(from, InvalidZoneOrdinal, false, s_forward);
+	LocalSearch(to, InvalidZoneOrdinal, true, s_backward);
+
+	uint32_t best = m_continents[from] == m_continents[to] ? s_forward.distance[to] : UINT32_MAX;
+	int bestGateway = -1;
+	int expanded = s_forward.expanded + s_backward.expanded;
+
+	// Search the overlay from the gateways we can reach, stopping once nothing left can beat the best route.
+	int gatewayCount = GetGatewayCount();
+	s_overlayDistance.assign(gatewayCount, UINT32_MAX);
+	s_overlayPrevEdge.assign(gatewayCount, NoEdge);
+	s_overlayPrevGateway.assign(gatewayCount, NoEdge);
+	s_overlayHeap.clear();
+
+	for (uint32_t gateway : m_continentGateways[m_continents[from]])
+	{
+		uint32_t distance = s_forward.distance[m_gateways[gateway]];
+		if (distance != UINT32_MAX)
+		{
+			s_overlayDistance[gateway] = distance;
+			s_overlayHeap.emplace_back(distance, gateway);
+		}
+	}
+
+	std::make_heap(s_overlayHeap.begin(), s_overlayHeap.end(), HeapCompare<uint32_t>);
+
+	while (!s_overlayHeap.empty())
+	{
+		std::pop_heap(s_overlayHeap.begin(), s_overlayHeap.end(), HeapCompare<uint32_t>);
+		auto [currentDistance, current] = s_overlayHeap.back();
+		s_overlayHeap.pop_back();
+
+		if (currentDistance > s_overlayDistance[current])
+			continue;
+
+		if (currentDistance >= best)
+			break;
+
+		++expanded;
+
+		// The backward search only covers the destination's continent.
+		uint32_t remaining = s_backward.distance[m_gateways[current]];
+		if (remaining != UINT32_MAX && currentDistance + remaining < best)
+		{
+			best = currentDistance + remaining;
+			bestGateway = (int)current;
+		}
+
+		for (uint32_t index = m_overlayOffsets[current]; index < m_overlayOffsets[current + 1]; ++index)
+		{
+			const OverlayEdge& edge = m_overlayEdges[index];
+
+			uint32_t newDistance = currentDistance + edge.cost;
+			if (newDistance < s_overlayDistance[edge.gateway])
+			{
+				s_overlayDistance[edge.gateway] = newDistance;
+				s_overlayPrevEdge[edge.gateway] = index;
+				s_overlayPrevGateway[edge.gateway] = current;
+				s_overlayHeap.emplace_back(newDistance, edge.gateway);
+				std::push_heap(s_overlayHeap.begin(), s_overlayHeap.end(), HeapCompare<uint32_t>);
+			}
+		}
+	}
+
+	if (nodesExpanded)
+		*nodesExpanded = expanded;
+
+	if (best == UINT32_MAX)
+		return true;
+
+	// Unpack the route into graph edges.
+	std::vector<uint32_t> edges;
+
+	auto appendForward = [&](ZoneOrdinal target)
+	{
+		size_t start = edges.size();
+		for (ZoneOrdinal current = target; current != from; current = m_graph->GetEdgeSource(s_forward.prevEdge[current]))
+			edges.push_back(s_forward.prevEdge[current]);
+
+		std::reverse(edges.begin() + start, edges.end());
+	};
+
+	if (bestGateway == -1)
+	{
+		appendForward(to);
+	}
+	else
+	{
+		std::vector<uint32_t> overlayRoute;
+		uint32_t gateway = (uint32_t)bestGateway;
+
+		for (; s_overlayPrevEdge[gateway] != NoEdge; gateway = s_overlayPrevGateway[gateway])
+			overlayRoute.push_back(s_overlayPrevEdge[gateway]);
+
+		appendForward(m_gateways[gateway]);
+
+		for (auto iter = overlayRoute.rbegin(); iter != overlayRoute.rend(); ++iter)
+		{
+			const OverlayEdge& edge = m_overlayEdges[*iter];
+
+			if (edge.edge != NoEdge)
+				edges.push_back(edge.edge);
+			else
+				AppendLocalRoute(m_gateways[gateway], m_gateways[edge.gateway], edges);
+
+			gateway = edge.gateway;
+		}
+
+		for (ZoneOrdinal current = m_gateways[bestGateway]; current != to; current = m_graph->GetEdge(s_backward.prevEdge[current]).destination)
+			edges.push_back(s_backward.prevEdge[current]);
+	}
+
+	outPath.reserve(edges.size() + 1);
+
+	ZoneOrdinal current = from;
+	for (uint32_t index : edges)
+	{
+		const ZoneGraphEdge& edge = m_graph->GetEdge(index);
+
+		outPath.push_back(ZoneGraph::MakePathNode(m_graph->GetNode(current).zoneId, &edge));
+		current = edge.destination;
+	}
+
+	outPath.emplace_back(m_graph->GetNode(current).zoneId, -1, 0, nullptr);
+	return true;
+}
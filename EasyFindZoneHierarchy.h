@@ -0,0 +1,76 @@
+#pragma once
+
+#include "EasyFindZoneGraph.h"
+
+// Two level routing over the zone graph. Zones are split up by continent, and the zones that have a
+// connection to or from another continent are gateways. The overlay connects every pair of gateways
+// on a continent by their shortest route inside it, and keeps the connections between continents.
+//
+// Any route leaves its starting continent through a gateway and enters the destination's continent
+// through one, so a search over the two local subgraphs and the overlay finds routes that are as
+// good as searching the whole graph. Teleports arrive from every zone, so routes that could use one
+// fall back to the flat search.
+class ZoneHierarchy
+{
+public:
+	// Builds the overlay for a routing mode and set of usable edges. Returns null if the mode isn't
+	// supported or there isn't more than one continent to split the graph into.
+	static std::shared_ptr<const ZoneHierarchy> Build(std::shared_ptr<const ZoneGraph> graph,
+		ZonePathRoutingMode mode, std::shared_ptr<const ZoneEdgeMask> edgeMask);
+
+	const std::shared_ptr<const ZoneGraph>& GetGraph() const { return m_graph; }
+	const std::shared_ptr<const ZoneEdgeMask>& GetEdgeMask() const { return m_edgeMask; }
+	ZonePathRoutingMode GetMode() const { return m_mode; }
+
+	int GetContinentCount() const { return (int)m_continentGateways.size(); }
+	int GetGatewayCount() const { return (int)m_gateways.size(); }
+	int GetOverlayEdgeCount() const { return (int)m_overlayEdges.size(); }
+	size_t GetMemoryUsage() const;
+
+	// Finds the cheapest route from `from` to `to`, leaving outPath empty if there is none. Returns
+	// false if the hierarchy can't answer the query and the flat search should be used instead.
+	bool FindPath(ZoneOrdinal from, ZoneOrdinal to, std::vector<ZonePathNode>& outPath, int* nodesExpanded = nullptr) const;
+
+private:
+	static constexpr uint32_t NoEdge = UINT32_MAX;
+
+	struct OverlayEdge
+	{
+		uint32_t gateway = 0;                             // destination, as an index into m_gateways
+		uint32_t cost = 0;
+		uint32_t edge = NoEdge;                           // graph edge for a connection between continents
+	};
+
+	// Results of a search that stays inside one continent.
+	struct LocalSearchState
+	{
+		std::vector<uint32_t> distance;
+		std::vector<uint32_t> prevEdge;                   // edge that was taken to reach (or leave, in reverse) a zone
+		std::vector<std::pair<uint32_t, ZoneOrdinal>> heap;
+		int expanded = 0;
+	};
+
+	uint32_t EdgeCost(uint32_t edge) const;
+
+	// Searches outward from `from` without leaving its continent, forward along edges or backward
+	// against them. Stops early once `to` is settled.
+	void LocalSearch(ZoneOrdinal from, ZoneOrdinal to, bool reverse, LocalSearchState& state) const;
+
+	// Appends the edges of the route inside one continent from `from` to `to`.
+	void AppendLocalRoute(ZoneOrdinal from, ZoneOrdinal to, std::vector<uint32_t>& outEdges) const;
+
+	std::shared_ptr<const ZoneGraph> m_graph;
+	std::shared_ptr<const ZoneEdgeMask> m_edgeMask;
+	ZonePathRoutingMode m_mode = ZonePathRoutingMode::FewestZones;
+
+	std::vector<int> m_continents;                        // dense continent index by ordinal
+	std::vector<int> m_gatewayIndices;                    // index into m_gateways by ordinal, or -1
+	std::vector<ZoneOrdinal> m_gateways;
+	std::vector<std::vector<uint32_t>> m_continentGateways;
+	std::vector<uint32_t> m_overlayOffsets;
+	std::vector<OverlayEdge> m_overlayEdges;
+};
+
+// Returns the hierarchy for the current zone graph. Only used until the graph's contraction is ready,
+// so it is null before the background build finishes and again after that.
+std::shared_ptr<const ZoneHierarchy> ZonePath_GetHierarchy();
@@ -3,9 +3,16 @@
 #include "EasyFindConfiguration.h"
 #include "EasyFindWindow.h"
 #include "EasyFindZoneConnections.h"
+#include "EasyFindZoneContraction.h"
+#include "EasyFindZoneGraph.h"
+#include "EasyFindZoneHierarchy.h"
 
+#include <condition_variable>
+#include <deque>
 #include <fstream>
 #include <filesystem>
+#include <mutex>
+#include <thread>
 
 static ZonePathRequest s_activeZonePathRequest;
 
@@ -13,6 +20,27 @@ static ZonePathRequest s_activeZonePathRequest;
 static bool s_travelToActive = false;
 static EQZoneIndex s_currentZone = 0;
 static bool s_findNextPath = false;
+static uint32_t s_activePathId = 0;              // changes whenever a different path is made active
+static uint32_t s_pendingPathId = 0;             // async request whose path will be made active, if any
+
+// A teleport spell we are memorizing so that we can cast it.
+static constexpr std::chrono::seconds PendingTeleportSpellTimeout{ 30 };
+static std::string s_pendingTeleportSpell;
+static std::chrono::steady_clock::time_point s_pendingTeleportSpellTimeout;
+
+// Generated routes, keyed by (from base zone, to zone) and only valid for s_routeCacheFingerprint.
+struct CachedRoute
+{
+	std::vector<ZonePathNode> path;
+	std::vector<ZonePathAlternative> alternatives;
+	int alternativeCount = 0;                            // alternatives asked for, there may be fewer
+	std::string message;
+	uint64_t readyMaskHash = 0;                          // which teleports were ready when it was found
+};
+static constexpr size_t MaxCachedRoutes = 1024;
+static std::unordered_map<uint64_t, CachedRoute> s_routeCache;
+static uint64_t s_routeCacheFingerprint = 0;
+static ZoneRouteCacheStats s_routeCacheStats;
 
 int FindTransferIndexByName(std::string_view name)
 {
@@ -27,200 +55,633 @@ int FindTransferIndexByName(std::string_view name)
 	return -1;
 }
 
+void ZonePath_ClearRouteCache()
+{
+	s_routeCache.clear();
+}
+
+ZoneRouteCacheStats ZonePath_GetRouteCacheStats()
+{
+	ZoneRouteCacheStats stats = s_routeCacheStats;
+	stats.entries = (uint32_t)s_routeCache.size();
+	return stats;
+}
+
 bool ZonePath_IsActive()
 {
 	return s_travelToActive;
 }
 
-// Generates a path to the zone by utilizing data from the ZoneGuideManagerClient.
-std::vector<ZonePathNode> ZonePath_GeneratePath(EQZoneIndex fromZone, EQZoneIndex toZone,
-	std::string& outputMessage)
+// Everything a path search needs. This is captured on the game thread, after which the search only
+// touches immutable data and can run on any thread.
+struct ZonePathSearch
+{
+	std::shared_ptr<const ZoneGraph> graph;
+	std::shared_ptr<const ZoneEdgeMask> edgeMask;        // with teleports that aren't ready turned off
+	std::vector<std::string> unreadyTeleports;           // routing data doesn't know about these
+	std::shared_ptr<const ZoneRoutingTable> routingTable;
+	std::shared_ptr<const ZoneContractionMetric> contraction;
+	std::shared_ptr<const ZoneHierarchy> hierarchy;
+	ZonePathRoutingMode mode = ZonePathRoutingMode::FewestZones;
+	bool bidirectional = false;
+	ZoneOrdinal from = InvalidZoneOrdinal;
+	ZoneOrdinal to = InvalidZoneOrdinal;
+	std::vector<ZoneOrdinal> targets;                    // instead of `to`, when looking for the nearest of several
+	std::optional<glm::vec3> startPosition;              // where we are, if starting from the current zone
+};
+
+// Checks the zones and captures the search inputs. Returns false with a message if there is nothing to search.
+static bool PrepareSearch(EQZoneIndex fromZone, EQZoneIndex toZone, ZonePathSearch& search, std::string& outputMessage)
 {
-	ZoneGuideManagerClient& zoneMgr = ZoneGuideManagerClient::Instance();
-
 	if (fromZone == toZone)
 	{
 		outputMessage = "Already at target zone";
-		return {};
+		return false;
 	}
 
 	EQZoneInfo* toZoneInfo = pWorldData->GetZone(toZone);
 	if (!toZoneInfo)
 	{
 		outputMessage = "Ending zone is not valid";
-		return {};
+		return false;
 	}
 
 	EQZoneInfo* fromZoneInfo = pWorldData->GetZone(fromZone);
 	if (!fromZoneInfo)
 	{
 		outputMessage = "Starting zone is not valid";
-		return {};
+		return false;
 	}
 
-	// Implements a breadth-first search of the zone connections
-	EQZoneIndex currentZoneId = pWorldData->GetZoneBaseId(fromZone);
-	std::deque<EQZoneIndex> queue;
-	struct ZonePathGenerationData {
-		int depth = -1;
-		int pathMinLevel = -1;
-		int prevZoneTransferTypeIndex = -1;
-		EQZoneIndex prevZone = 0;
+	search.graph = ZonePath_GetGraph();
+	std::shared_ptr<const ZoneEdgeMask> edgeMask = ZonePath_GetEdgeMask();
+	if (!search.graph || !edgeMask)
+	{
+		outputMessage = "Zone data is not loaded";
+		return false;
+	}
 
-		// information about the origin of this link
-		const ParsedFindableLocation* location = nullptr;
-		const ZoneGuideConnection* connection = nullptr;
-	};
-	std::unordered_map<EQZoneIndex, ZonePathGenerationData> pathData;
+	search.from = search.graph->GetOrdinal(pWorldData->GetZoneBaseId(fromZone));
+	search.to = search.graph->GetOrdinal(toZone);
+
+	if (search.from == InvalidZoneOrdinal || search.to == InvalidZoneOrdinal)
+	{
+		outputMessage = "Could not find path to target zone.";
+		return false;
+	}
+
+	// Turn away destinations that no route leads to without searching for one.
+	std::shared_ptr<const ZoneReachability> reachability = ZonePath_GetReachability();
+	if (reachability && reachability->GetEdgeMask() == edgeMask && !reachability->CanReach(search.from, search.to))
+	{
+		outputMessage = "Could not find path to target zone. " + reachability->DescribeBoundary(search.from, search.to);
+		return false;
+	}
 
-	queue.push_back(currentZoneId);
-	pathData[fromZone].depth = 0;
-	pathData[fromZone].pathMinLevel = 0;
+	// Routing data is built assuming every teleport is ready, so remember which ones aren't.
+	search.edgeMask = ZonePath_GetReadyEdgeMask();
+	if (search.edgeMask != edgeMask)
+	{
+		for (const ZoneGraphEdge* edge = search.graph->UniversalEdgesBegin(); edge != search.graph->UniversalEdgesEnd(); ++edge)
+		{
+			uint32_t index = search.graph->GetEdgeIndex(edge);
+			if (edgeMask->Test(index) && !search.edgeMask->Test(index))
+				search.unreadyTeleports.push_back(edge->teleportName);
+		}
+	}
+
+	search.mode = g_configuration->GetRoutingMode();
+	search.bidirectional = g_configuration->IsBidirectionalSearchEnabled();
 
-	if (const ZoneGuideZone* z = zoneMgr.GetZone(currentZoneId))
-		pathData[fromZone].pathMinLevel = z->minLevel;
+	if (pLocalPlayer && pWorldData->GetZoneBaseId(pLocalPlayer->GetZoneID()) == pWorldData->GetZoneBaseId(fromZone))
+		search.startPosition = glm::vec3(pLocalPlayer->Y, pLocalPlayer->X, pLocalPlayer->Z);
 
-	// TODO: Handle bind zones (gate)
-	// TODO: Handle teleport spell zones (translocate, etc)
+	std::shared_ptr<const ZoneRoutingTable> routingTable = ZonePath_GetRoutingTable();
+	if (routingTable && routingTable->GetGraph() == search.graph && routingTable->GetMode() == search.mode)
+		search.routingTable = std::move(routingTable);
 
-	auto addTransfer = [&](EQZoneIndex destZoneId, int transferTypeIndex, int minLevel,
-		const ParsedFindableLocation* location, const ZoneGuideConnection* connection)
+	std::shared_ptr<const ZoneContractionMetric> contraction = ZonePath_GetContractionMetric();
+	if (contraction && contraction->GetGraph() == search.graph && contraction->GetMode() == search.mode
+		&& contraction->GetEdgeMask() == edgeMask)
 	{
-		auto& data = pathData[destZoneId];
-		auto& prevData = pathData[currentZoneId];
+		search.contraction = std::move(contraction);
+	}
 
-		data.location = location;
-		data.connection = connection;
+	std::shared_ptr<const ZoneHierarchy> hierarchy = ZonePath_GetHierarchy();
+	if (hierarchy && hierarchy->GetGraph() == search.graph && hierarchy->GetMode() == search.mode
+		&& hierarchy->GetEdgeMask() == edgeMask)
+	{
+		search.hierarchy = std::move(hierarchy);
+	}
+
+	return true;
+}
 
-		if (data.depth == -1)
+static bool UsesUnreadyTeleport(const ZonePathSearch& search, const std::vector<ZonePathNode>& path)
+{
+	return std::any_of(path.begin(), path.end(), [&](const ZonePathNode& node)
 		{
-			queue.push_back(destZoneId);
+			return !node.teleport.empty() && std::find(search.unreadyTeleports.begin(),
+				search.unreadyTeleports.end(), node.teleport) != search.unreadyTeleports.end();
+		});
+}
 
-			data.prevZoneTransferTypeIndex = transferTypeIndex;
-			data.prevZone = currentZoneId;
-			data.pathMinLevel = std::max(prevData.pathMinLevel, minLevel);
+static bool RunSearch(const ZonePathSearch& search, std::vector<ZonePathNode>& outPath, std::string& outputMessage,
+	int* nodesExpanded = nullptr)
+{
+	bool found = false;
+	bool searched = true;
+
+	// The routing table is a lookup, so it doesn't expand any zones.
+	if (nodesExpanded)
+		*nodesExpanded = 0;
+
+	// Fastest travel depends on where each connection lands, which only the arrival search knows about.
+	// Otherwise use whichever routing data the mode has: the routing table for lowest level zones, or
+	// the contraction (or the continent hierarchy until it is ready) for the others. Without any, search
+	// the graph.
+	if (search.graph->UsesArrivalSearch(search.mode))
+	{
+		found = search.graph->FindPathByArrival(search.from, search.to, *search.edgeMask,
+			search.startPosition ? &*search.startPosition : nullptr, outPath, nodesExpanded);
+	}
+	else if (search.routingTable)
+		found = search.routingTable->GetPath(search.from, search.to, outPath);
+	else if (search.contraction && search.contraction->FindPath(search.from, search.to, outPath, nodesExpanded))
+		found = !outPath.empty();
+	else if (search.hierarchy && search.hierarchy->FindPath(search.from, search.to, outPath, nodesExpanded))
+		found = !outPath.empty();
+	else
+		searched = false;
 
-			data.depth = prevData.depth + 1;
-		}
-		else if (data.prevZone && (data.depth == prevData.depth + 1)
-			&& pathData[data.prevZone].pathMinLevel > prevData.pathMinLevel)
-		{
-			// lower level preference?
-			data.prevZoneTransferTypeIndex = transferTypeIndex;
-			data.prevZone = currentZoneId;
-			data.pathMinLevel = std::max(prevData.pathMinLevel, minLevel);
-		}
+	// Routing data assumes every teleport is ready. Its route is still the best one if it doesn't take
+	// one that isn't, otherwise search the graph without them.
+	if (found && UsesUnreadyTeleport(search, outPath))
+		searched = false;
+
+	if (!searched && search.bidirectional)
+		found = search.graph->FindPathBidirectional(search.from, search.to, search.mode, *search.edgeMask, outPath, nodesExpanded);
+	else if (!searched)
+		found = search.graph->FindPath(search.from, search.to, search.mode, *search.edgeMask, outPath, nodesExpanded);
+
+	if (!found)
+		outputMessage = "Could not find path to target zone.";
+
+	return found;
+}
+
+static std::vector<ZonePathAlternative> FindAlternatives(const ZonePathSearch& search,
+	const std::vector<ZonePathNode>& primaryPath, int count)
+{
+	std::vector<ZonePathAlternative> alternatives;
+	if (count <= 0)
+		return alternatives;
+
+	auto samePath = [](const std::vector<ZonePathNode>& a, const std::vector<ZonePathNode>& b)
+	{
+		return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+			[](const ZonePathNode& x, const ZonePathNode& y)
+			{
+				return x.zoneId == y.zoneId && x.transferTypeIndex == y.transferTypeIndex
+					&& x.zoneIdentifier == y.zoneIdentifier && x.connection == y.connection && x.teleport == y.teleport;
+			});
 	};
 
-	int otherIndex = FindTransferIndexByName("Other");
-	int zoneLineIndex = FindTransferIndexByName("Zone Line");
-	int translocatorIndex = FindTransferIndexByName("Translocator");
+	// Ask for one extra, since one of them is usually the primary route.
+	for (const ZoneGraphRoute& route : search.graph->FindAlternativeRoutes(search.from, search.to,
+		search.mode, *search.edgeMask, count + 1))
+	{
+		ZonePathAlternative alternative;
+		alternative.cost = route.cost;
+		search.graph->GetRoutePath(search.from, route, alternative.zonePath);
+
+		if (samePath(alternative.zonePath, primaryPath))
+			continue;
+
+		alternatives.push_back(std::move(alternative));
+		if ((int)alternatives.size() == count)
+			break;
+	}
+
+	return alternatives;
+}
+
+static uint64_t GetRouteCacheKey(EQZoneIndex fromZone, EQZoneIndex toZone)
+{
+	return ((uint64_t)(uint32_t)pWorldData->GetZoneBaseId(fromZone) << 32) | (uint32_t)toZone;
+}
+
+// Routes found by the arrival search start from where we are standing, which the cache key doesn't
+// know about, so those aren't cached.
+static bool IsRouteCacheable(const ZonePathSearch& search)
+{
+	return !search.startPosition || !search.graph->UsesArrivalSearch(search.mode);
+}
+
+// Returns the cached route if it has at least alternativeCount alternatives, after dropping the cache
+// if the requirements changed since it was filled. Routes found while a different set of teleports
+// was ready don't count.
+static const CachedRoute* FindCachedRoute(uint64_t key, uint64_t readyMaskHash, int alternativeCount)
+{
+	uint64_t fingerprint = ZonePath_GetRequirementFingerprint();
+	if (fingerprint != s_routeCacheFingerprint)
+	{
+		s_routeCache.clear();
+		s_routeCacheFingerprint = fingerprint;
+	}
+
+	auto iter = s_routeCache.find(key);
+	if (iter == s_routeCache.end() || iter->second.readyMaskHash != readyMaskHash
+		|| (iter->second.alternativeCount < alternativeCount && !iter->second.path.empty()))
+	{
+		++s_routeCacheStats.misses;
+		return nullptr;
+	}
+
+	++s_routeCacheStats.hits;
+	return &iter->second;
+}
+
+static void AddCachedRoute(uint64_t key, CachedRoute&& route)
+{
+	// Don't remember anything while the graph is still loading.
+	if (!ZonePath_GetGraph())
+		return;
+
+	// Don't replace a route that came with more alternatives.
+	auto iter = s_routeCache.find(key);
+	if (iter != s_routeCache.end() && iter->second.readyMaskHash == route.readyMaskHash
+		&& iter->second.alternativeCount > route.alternativeCount)
+	{
+		return;
+	}
+
+	if (s_routeCache.size() >= MaxCachedRoutes)
+		s_routeCache.clear();
+
+	s_routeCache.insert_or_assign(key, std::move(route));
+}
+
+std::vector<ZonePathNode> ZonePath_GeneratePath(EQZoneIndex fromZone, EQZoneIndex toZone,
+	std::string& outputMessage, int* nodesExpanded)
+{
+	std::vector<ZonePathNode> path;
+	ZonePathSearch search;
+
+	if (!PrepareSearch(fromZone, toZone, search, outputMessage))
+		return path;
+
+	// The same route keeps getting asked for, and it can only change if the fingerprint or the
+	// teleports that are ready do.
+	uint64_t key = GetRouteCacheKey(fromZone, toZone);
+	uint64_t readyMaskHash = search.edgeMask->Hash();
+	bool cacheable = IsRouteCacheable(search);
+
+	if (const CachedRoute* cached = cacheable ? FindCachedRoute(key, readyMaskHash, 0) : nullptr)
+	{
+		if (nodesExpanded)
+			*nodesExpanded = 0;
+
+		outputMessage = cached->message;
+		return cached->path;
+	}
+
+	RunSearch(search, path, outputMessage, nodesExpanded);
+
+	if (cacheable)
+		AddCachedRoute(key, CachedRoute{ path, {}, 0, outputMessage, readyMaskHash });
+	return path;
+}
+
+// Finds the next best routes after the primary one. Routes that are the same as primaryPath are skipped.
+std::vector<ZonePathAlternative> ZonePath_GenerateAlternatives(EQZoneIndex fromZone, EQZoneIndex toZone,
+	const std::vector<ZonePathNode>& primaryPath, int count)
+{
+	ZonePathSearch search;
+	std::string message;
+
+	if (!PrepareSearch(fromZone, toZone, search, message))
+		return {};
+
+	return FindAlternatives(search, primaryPath, count);
+}
+
+//============================================================================
 
-	// Explore the zone graph and cost everything out.
-	while (!queue.empty())
+// Searches for asynchronous path requests run on one worker thread. Finished requests are queued up
+// and handed back to their callbacks from the pulse.
+struct ZonePathJob
+{
+	ZonePathSearch search;
+	EQZoneIndex fromZone = 0;
+	EQZoneIndex toZone = 0;
+	std::vector<EQZoneIndex> toZones;                    // for nearest searches
+	int alternativeCount = 0;
+	uint64_t cacheKey = 0;
+	uint64_t fingerprint = 0;
+	uint64_t readyMaskHash = 0;
+	bool cacheable = false;
+	uint32_t activePathId = 0;                           // for requests that activate their path, see below
+	ZonePathCallback callback;
+
+	// results
+	ZonePathRequest request;
+	std::string message;
+	bool found = false;
+};
+
+static std::thread s_pathWorker;
+static std::mutex s_pathJobsMutex;
+static std::condition_variable s_pathJobsCondition;
+static std::deque<ZonePathJob> s_pathJobs;
+static bool s_pathWorkerStopping = false;
+
+static std::mutex s_pathCompletionsMutex;
+static std::vector<ZonePathJob> s_pathCompletions;
+
+// Requests made while the zone graph is being built. They are asked again once it is published.
+static std::vector<ZonePathJob> s_jobsWaitingForGraph;
+
+static void QueuePathCompletion(ZonePathJob&& job)
+{
+	std::scoped_lock lock(s_pathCompletionsMutex);
+	s_pathCompletions.push_back(std::move(job));
+}
+
+// Holds on to a request that failed because there is no zone graph yet, if one is on its way.
+static bool WaitForGraph(ZonePathJob& job)
+{
+	if (job.search.graph || !ZonePath_IsGraphBuilding())
+		return false;
+
+	s_jobsWaitingForGraph.push_back(std::move(job));
+	return true;
+}
+
+static void PathWorkerThread()
+{
+	while (true)
 	{
-		currentZoneId = queue.front();
-		queue.pop_front();
+		ZonePathJob job;
 
-		// Did we find a connection to the destination?
-		if (pathData[toZone].depth > -1 && pathData[toZone].depth < pathData[currentZoneId].depth)
 		{
-			break;
+			std::unique_lock lock(s_pathJobsMutex);
+			s_pathJobsCondition.wait(lock, [] { return s_pathWorkerStopping || !s_pathJobs.empty(); });
+
+			if (s_pathWorkerStopping)
+				return;
+
+			job = std::move(s_pathJobs.front());
+			s_pathJobs.pop_front();
 		}
 
-		const EZZoneData& ezZoneData = g_zoneConnections->GetZoneData(currentZoneId);
+		if (!job.search.targets.empty())
+		{
+			job.found = job.search.graph->FindPathToNearest(job.search.from, job.search.targets, job.search.mode,
+				*job.search.edgeMask, job.request.zonePath, &job.request.nodesExpanded) != InvalidZoneOrdinal;
 
-		if (ZoneGuideZone* currentZone = zoneMgr.GetZone(currentZoneId))
+			if (!job.found)
+				job.message = "Could not find path to any of the target zones.";
+		}
+		else
 		{
-			// Search the zone guide with modified parameters.
-			for (const ZoneGuideConnection& connection : currentZone->zoneConnections)
-			{
-				// Skip connection if it is disabled by the user.
-				if (connection.disabled)
-					continue;
+			job.found = RunSearch(job.search, job.request.zonePath, job.message, &job.request.nodesExpanded);
+			if (job.found)
+				job.request.alternatives = FindAlternatives(job.search, job.request.zonePath, job.alternativeCount);
+		}
 
-				// Make sure that progression server expansion is available.
-				if (connection.requiredExpansions != 0 && pEverQuestInfo->bProgressionServer)
-				{
-					if ((pEverQuestInfo->ProgressionOpenExpansions & connection.requiredExpansions) != connection.requiredExpansions)
-						continue;
-				}
+		QueuePathCompletion(std::move(job));
+	}
+}
+
+static void QueuePathJob(ZonePathJob&& job)
+{
+	if (!s_pathWorker.joinable())
+	{
+		s_pathWorkerStopping = false;
+		s_pathWorker = std::thread(PathWorkerThread);
+	}
 
-				// Make sure we didn't remove this connection
-				if (std::find(ezZoneData.removedConnections.begin(), ezZoneData.removedConnections.end(), connection.destZoneId) != ezZoneData.removedConnections.end())
-					continue;
+	{
+		std::scoped_lock lock(s_pathJobsMutex);
+		s_pathJobs.push_back(std::move(job));
+	}
 
-				// Make sure that the transfer types are supported
-				if (g_configuration->IsDisabledTransferType(connection.transferTypeIndex))
-					continue;
+	s_pathJobsCondition.notify_one();
+}
 
-				addTransfer(connection.destZoneId, connection.transferTypeIndex, currentZone->minLevel, nullptr, &connection);
-				continue;
-			}
-		}
+// Requests whose path will be made active take the next active path id. Making any other path active
+// changes the id, which drops them.
+static uint32_t BeginActivatingRequest()
+{
+	s_pendingPathId = ++s_activePathId;
+	return s_pendingPathId;
+}
 
-		// Search our own connections
-		for (const ParsedFindableLocation& location : ezZoneData.findableLocations)
-		{
-			if (!location.IsZoneConnection())
-				continue;
+static bool HasPendingActivation()
+{
+	return s_pendingPathId != 0 && s_pendingPathId == s_activePathId;
+}
 
-			if (!location.CheckRequirements())
-				continue;
+static void QueueGeneratePath(EQZoneIndex fromZone, EQZoneIndex toZone, int alternativeCount, ZonePathCallback callback,
+	uint32_t activePathId)
+{
+	ZonePathJob job;
+	job.fromZone = fromZone;
+	job.toZone = toZone;
+	job.alternativeCount = alternativeCount;
+	job.activePathId = activePathId;
+	job.callback = std::move(callback);
+
+	// Requests that fail up front and cached routes don't need the worker.
+	if (!PrepareSearch(fromZone, toZone, job.search, job.message))
+	{
+		if (!WaitForGraph(job))
+			QueuePathCompletion(std::move(job));
+		return;
+	}
 
-			int transferTypeIndex = otherIndex;
+	job.cacheKey = GetRouteCacheKey(fromZone, toZone);
+	job.readyMaskHash = job.search.edgeMask->Hash();
+	job.cacheable = IsRouteCacheable(job.search);
 
-			if (location.type == LocationType::Location)
-				transferTypeIndex = zoneLineIndex;
-			else if (location.type == LocationType::Translocator)
-				transferTypeIndex = translocatorIndex;
+	const CachedRoute* cached = job.cacheable ? FindCachedRoute(job.cacheKey, job.readyMaskHash, alternativeCount) : nullptr;
+	job.fingerprint = s_routeCacheFingerprint;
 
-			if (location.zoneId != 0)
-				addTransfer(location.zoneId, transferTypeIndex, 0, &location, nullptr);
-			for (const auto& dest : location.translocatorDestinations)
-			{
-				if (dest.zoneId != 0)
-					addTransfer(dest.zoneId, translocatorIndex, 0, &location, nullptr);
-			}
+	if (cached)
+	{
+		job.request.zonePath = cached->path;
+		job.request.alternatives.assign(cached->alternatives.begin(),
+			cached->alternatives.begin() + std::min<size_t>(std::max(alternativeCount, 0), cached->alternatives.size()));
+		job.message = cached->message;
+		job.found = !cached->path.empty();
+
+		QueuePathCompletion(std::move(job));
+		return;
+	}
+
+	QueuePathJob(std::move(job));
+}
+
+void ZonePath_GeneratePathAsync(EQZoneIndex fromZone, EQZoneIndex toZone, int alternativeCount, ZonePathCallback callback,
+	bool activates)
+{
+	QueueGeneratePath(fromZone, toZone, alternativeCount, std::move(callback), activates ? BeginActivatingRequest() : 0);
+}
+
+// Checks the zones and captures the inputs for a search for the nearest of toZones. Zones that can't
+// be reached are left out up front.
+static bool PrepareNearestSearch(EQZoneIndex fromZone, const std::vector<EQZoneIndex>& toZones, ZonePathSearch& search,
+	std::string& outputMessage)
+{
+	if (!pWorldData->GetZone(fromZone))
+	{
+		outputMessage = "Starting zone is not valid";
+		return false;
+	}
+
+	search.graph = ZonePath_GetGraph();
+	search.edgeMask = ZonePath_GetReadyEdgeMask();
+	if (!search.graph || !search.edgeMask)
+	{
+		outputMessage = "Zone data is not loaded";
+		return false;
+	}
+
+	search.from = search.graph->GetOrdinal(pWorldData->GetZoneBaseId(fromZone));
+	search.mode = g_configuration->GetRoutingMode();
+
+	std::shared_ptr<const ZoneReachability> reachability = ZonePath_GetReachability();
+	if (reachability && reachability->GetEdgeMask() != ZonePath_GetEdgeMask())
+		reachability.reset();
+
+	for (EQZoneIndex toZone : toZones)
+	{
+		ZoneOrdinal ordinal = search.graph->GetOrdinal(toZone);
+		if (ordinal == InvalidZoneOrdinal || search.from == InvalidZoneOrdinal)
+			continue;
+
+		if (ordinal == search.from)
+		{
+			outputMessage = "Already at target zone";
+			return false;
 		}
+
+		if (reachability && !reachability->CanReach(search.from, ordinal))
+			continue;
+
+		search.targets.push_back(ordinal);
 	}
 
-	// Work backwards from the destination and build the route.
-	EQZoneIndex zoneId = toZone;
-	int transferTypeIndex = -1;
-	const ParsedFindableLocation* location = nullptr;
-	const ZoneGuideConnection* connection = nullptr;
+	if (search.targets.empty())
+	{
+		outputMessage = "Could not find path to any of the target zones.";
+		return false;
+	}
+
+	return true;
+}
 
-	std::vector<ZonePathNode> reversedPath;
+// Finds the route to whichever of the zones is closest, with a single search that stops at the first
+// target it reaches.
+static void QueueGenerateNearestPath(EQZoneIndex fromZone, const std::vector<EQZoneIndex>& toZones,
+	ZonePathCallback callback, uint32_t activePathId)
+{
+	ZonePathJob job;
+	job.fromZone = fromZone;
+	job.toZones = toZones;
+	job.activePathId = activePathId;
+	job.callback = std::move(callback);
 
-	while (zoneId != 0)
+	if (!PrepareNearestSearch(fromZone, toZones, job.search, job.message))
 	{
-		reversedPath.emplace_back(zoneId, transferTypeIndex, location, connection);
+		if (!WaitForGraph(job))
+			QueuePathCompletion(std::move(job));
+		return;
+	}
+
+	QueuePathJob(std::move(job));
+}
+
+void ZonePath_GenerateNearestPathAsync(EQZoneIndex fromZone, const std::vector<EQZoneIndex>& toZones,
+	ZonePathCallback callback, bool activates)
+{
+	QueueGenerateNearestPath(fromZone, toZones, std::move(callback), activates ? BeginActivatingRequest() : 0);
+}
+
+static void RequeuePathJob(ZonePathJob&& job)
+{
+	if (!job.toZones.empty())
+		QueueGenerateNearestPath(job.fromZone, job.toZones, std::move(job.callback), job.activePathId);
+	else
+		QueueGeneratePath(job.fromZone, job.toZone, job.alternativeCount, std::move(job.callback), job.activePathId);
+}
+
+static void DrainPathCompletions()
+{
+	if (!s_jobsWaitingForGraph.empty() && !ZonePath_IsGraphBuilding())
+	{
+		std::vector<ZonePathJob> waiting;
+		waiting.swap(s_jobsWaitingForGraph);
 
-		transferTypeIndex = pathData[zoneId].prevZoneTransferTypeIndex;
-		zoneId = pathData[zoneId].prevZone;
-		location = pathData[zoneId].location;
-		connection = pathData[zoneId].connection;
+		for (ZonePathJob& job : waiting)
+		{
+			if (job.activePathId == 0 || job.activePathId == s_activePathId)
+				RequeuePathJob(std::move(job));
+		}
 	}
 
-	if (reversedPath.size() <= 1)
+	std::vector<ZonePathJob> completions;
+
 	{
-		outputMessage = "Could not find path to target zone.";
+		std::scoped_lock lock(s_pathCompletionsMutex);
+		completions.swap(s_pathCompletions);
 	}
 
-	std::vector<ZonePathNode> newPath;
-	newPath.reserve(reversedPath.size());
+	for (ZonePathJob& job : completions)
+	{
+		// A different path was made active, or /travelto was stopped, since this was asked for.
+		if (job.activePathId != 0 && job.activePathId != s_activePathId)
+			continue;
+
+		// The graph was replaced while this was being searched, so the result may point at data that
+		// no longer exists. Ask again.
+		if (job.search.graph && job.search.graph != ZonePath_GetGraph())
+		{
+			RequeuePathJob(std::move(job));
+			continue;
+		}
+
+		if (job.cacheable && job.search.graph && job.fingerprint == s_routeCacheFingerprint)
+		{
+			AddCachedRoute(job.cacheKey, CachedRoute{ job.request.zonePath, job.request.alternatives,
+				job.alternativeCount, job.message, job.readyMaskHash });
+		}
+
+		if (job.activePathId != 0)
+			s_pendingPathId = 0;
 
-	// If we made it back to the start, then flip the list around and return it.
-	if (!reversedPath.empty() && reversedPath.back().zoneId == fromZone)
+		job.callback(job.request, job.message);
+	}
+}
+
+void ZonePath_StopPathWorker()
+{
+	if (s_pathWorker.joinable())
 	{
-		for (auto riter = reversedPath.rbegin(); riter != reversedPath.rend(); ++riter)
 		{
-			newPath.push_back(*riter);
+			std::scoped_lock lock(s_pathJobsMutex);
+			s_pathWorkerStopping = true;
 		}
+
+		s_pathJobsCondition.notify_one();
+		s_pathWorker.join();
 	}
 
-	return newPath;
+	s_pathJobs.clear();
+	s_pathCompletions.clear();
+	s_jobsWaitingForGraph.clear();
+	s_pendingPathId = 0;
 }
 
 void ZonePath_FollowActive()
@@ -240,6 +701,57 @@ void StopTravelTo(bool success)
 	s_travelToActive = false;
 }
 
+// Switches the active /travelto to an alternative route that leaves the current zone some other way
+// than toward failedZone. Returns false if there is no such alternative.
+static bool SwitchToAlternative(EQZoneIndex failedZone)
+{
+	ZonePathRequest& request = s_activeZonePathRequest;
+
+	for (auto iter = request.alternatives.begin(); iter != request.alternatives.end(); ++iter)
+	{
+		const std::vector<ZonePathNode>& zonePath = iter->zonePath;
+
+		auto current = std::find_if(zonePath.begin(), zonePath.end(),
+			[](const ZonePathNode& node) { return node.zoneId == s_currentZone; });
+
+		if (current == zonePath.end() || current + 1 == zonePath.end() || (current + 1)->zoneId == failedZone)
+			continue;
+
+		ZonePathRequest newRequest;
+		newRequest.zonePath.assign(current, zonePath.end());
+		newRequest.targetQuery = request.targetQuery;
+
+		// Every other alternative is still a fallback for this one.
+		for (auto other = request.alternatives.begin(); other != request.alternatives.end(); ++other)
+		{
+			if (other != iter)
+				newRequest.alternatives.push_back(std::move(*other));
+		}
+
+		SPDLOG_INFO("Connection to \ay{}\ax failed, switching to an alternative route through \ay{}\ax",
+			GetFullZone(failedZone), GetFullZone(newRequest.zonePath[1].zoneId));
+
+		ZonePath_SetActive(newRequest, true);
+		return true;
+	}
+
+	return false;
+}
+
+// Returns the zone the active path goes to from the current zone, or 0 if it isn't on the path.
+static EQZoneIndex GetNextZone()
+{
+	const std::vector<ZonePathNode>& zonePath = s_activeZonePathRequest.zonePath;
+
+	for (size_t i = 0; i + 1 < zonePath.size(); ++i)
+	{
+		if (zonePath[i].zoneId == s_currentZone)
+			return zonePath[i + 1].zoneId;
+	}
+
+	return 0;
+}
+
 static bool ActivateNextPath()
 {
 	// Wait to update until we have all of our locations updated.
@@ -251,6 +763,8 @@ static bool ActivateNextPath()
 		{
 			EQZoneIndex nextZoneId = 0;
 			int transferTypeIndex = -1;
+			int zoneIdentifier = 0;
+			std::string teleportName;
 
 			// Find the next zone to travel to!
 			for (size_t i = 0; i < s_activeZonePathRequest.zonePath.size() - 1; ++i)
@@ -259,14 +773,36 @@ static bool ActivateNextPath()
 				{
 					nextZoneId = s_activeZonePathRequest.zonePath[i + 1].zoneId;
 					transferTypeIndex = s_activeZonePathRequest.zonePath[i].transferTypeIndex;
+					zoneIdentifier = s_activeZonePathRequest.zonePath[i].zoneIdentifier;
+					teleportName = s_activeZonePathRequest.zonePath[i].teleport;
 					break;
 				}
 			}
 
-			if (nextZoneId != 0)
+			if (nextZoneId != 0 && !teleportName.empty())
 			{
-				if (pFindLocWnd->FindZoneConnectionByZoneIndex(nextZoneId, false))
+				// Teleports don't need a connection in this zone, just use it and wait for the zone change.
+				// Look it up again, the zone connections may have been reloaded since the path was made.
+				const ParsedTeleport* teleport = g_zoneConnections->FindTeleport(teleportName);
+				if (s_travelToActive && teleport && teleport->IsReady())
+				{
+					teleport->Use();
 					return true;
+				}
+
+				if (s_travelToActive && SwitchToAlternative(nextZoneId))
+					return false;
+
+				StopTravelTo(false);
+			}
+			else if (nextZoneId != 0)
+			{
+				// The route may have picked one of several connections into the next zone by where it lands.
+				if (pFindLocWnd->FindZoneConnectionByZoneIndex(nextZoneId, false, zoneIdentifier))
+					return true;
+
+				if (s_travelToActive && SwitchToAlternative(nextZoneId))
+					return false;
 
 				StopTravelTo(false);
 			}
@@ -282,6 +818,8 @@ static bool ActivateNextPath()
 
 void ZonePath_SetActive(const ZonePathRequest& zonePathData, bool travel)
 {
+	++s_activePathId;
+
 	ZonePathArray pathArray((int)zonePathData.zonePath.size());
 
 	for (const ZonePathNode& pathData : zonePathData.zonePath)
@@ -306,6 +844,75 @@ void ZonePath_SetActive(const ZonePathRequest& zonePathData, bool travel)
 	}
 }
 
+// Reroutes an active path after we ended up in a zone that isn't on it. Instead of planning the whole
+// trip again, find the cheapest way back onto the part of the route we haven't traveled yet and keep
+// the rest of it. Returns false if we can't get back onto the route.
+static bool RepairPath(EQZoneIndex currentZone, EQZoneIndex previousZone, std::vector<ZonePathNode>& zonePath)
+{
+	std::shared_ptr<const ZoneGraph> graph = ZonePath_GetGraph();
+	std::shared_ptr<const ZoneEdgeMask> edgeMask = ZonePath_GetReadyEdgeMask();
+	if (!graph || !edgeMask || zonePath.empty())
+		return false;
+
+	ZoneOrdinal fromOrdinal = graph->GetOrdinal(currentZone);
+	if (fromOrdinal == InvalidZoneOrdinal)
+		return false;
+
+	// Everything from the zone we left onward is still ahead of us. If we don't know where we
+	// were, the whole route is fair game.
+	size_t firstRemaining = 0;
+	for (size_t i = 0; i < zonePath.size(); ++i)
+	{
+		if (zonePath[i].zoneId == previousZone)
+		{
+			firstRemaining = i;
+			break;
+		}
+	}
+
+	std::vector<ZonePathNode> detour;
+	size_t rejoinIndex = zonePath.size();
+
+	// The arrival search weighs the whole remaining trip from where we are standing, so let a new
+	// search decide where to rejoin the route.
+	ZonePathRoutingMode mode = g_configuration->GetRoutingMode();
+	if (graph->UsesArrivalSearch(mode))
+		return false;
+
+	// Search outward until we hit the nearest zone that is still on the route.
+	std::vector<ZoneOrdinal> targets;
+	targets.reserve(zonePath.size() - firstRemaining);
+
+	for (size_t i = firstRemaining; i < zonePath.size(); ++i)
+		targets.push_back(graph->GetOrdinal(zonePath[i].zoneId));
+
+	ZoneOrdinal reached = graph->FindPathToNearest(fromOrdinal, targets, mode, *edgeMask, detour);
+	if (reached == InvalidZoneOrdinal)
+		return false;
+
+	// Rejoin at the last occurrence, in case the route passes through the same zone twice.
+	for (size_t i = zonePath.size(); i-- > firstRemaining;)
+	{
+		if (graph->GetOrdinal(zonePath[i].zoneId) == reached)
+		{
+			rejoinIndex = i;
+			break;
+		}
+	}
+
+	if (rejoinIndex == zonePath.size())
+		return false;
+
+	// The last node of the detour is the zone we rejoin at. Keep the original node, since it
+	// carries the transfer that continues along the route.
+	SPDLOG_DEBUG("Rerouted back onto the active path at \ay{}\ax", GetFullZone(zonePath[rejoinIndex].zoneId));
+
+	detour.pop_back();
+	detour.insert(detour.end(), zonePath.begin() + rejoinIndex, zonePath.end());
+	zonePath = std::move(detour);
+	return true;
+}
+
 static void UpdateForZoneChange()
 {
 	// Update current zone
@@ -317,6 +924,7 @@ static void UpdateForZoneChange()
 	if (!pFindLocWnd->IsCustomLocationsAdded())
 		return;
 
+	EQZoneIndex previousZone = s_currentZone;
 	s_currentZone = pWorldData->GetZoneBaseId(pLocalPlayer->GetZoneID());
 
 	// If zone path is active then update it.
@@ -351,14 +959,29 @@ static void UpdateForZoneChange()
 
 			if (!found)
 			{
-				std::string message;
-				auto newPath = ZonePath_GeneratePath(s_currentZone, destZone, message);
-				if (newPath.empty())
+				auto newRequest = s_activeZonePathRequest;
+
+				// Try to get back onto the route we were following before planning a new one.
+				if (!RepairPath(s_currentZone, previousZone, newRequest.zonePath))
 				{
-					SPDLOG_WARN("Path generation failed: {}", message);
+					// Plan the new route off the game thread, and hold off on traveling until it comes
+					// back. It is dropped if a different path is made active in the meantime.
+					s_findNextPath = false;
+
+					ZonePath_GeneratePathAsync(s_currentZone, destZone, MaxZonePathAlternatives,
+						[travel = s_travelToActive, targetQuery = std::move(newRequest.targetQuery)](
+							ZonePathRequest& request, const std::string& message)
+						{
+							if (request.zonePath.empty())
+							{
+								SPDLOG_WARN("Path generation failed: {}", message);
+							}
+
+							request.targetQuery = targetQuery;
+							ZonePath_SetActive(request, travel);
+						}, true);
+					return;
 				}
-				auto newRequest = s_activeZonePathRequest;
-				newRequest.zonePath = newPath;
 
 				ZonePath_SetActive(newRequest, s_travelToActive);
 			}
@@ -371,8 +994,112 @@ static void UpdateForZoneChange()
 	}
 }
 
+// Returns the first empty spell gem, or 0 if every gem has a spell in it.
+static int FindEmptySpellGem()
+{
+	int gemCount = GetIntFromString(EvaluateMacroString("${Me.NumGems}"), 8);
+
+	for (int gem = 1; gem <= gemCount; ++gem)
+	{
+		if (GetIntFromString(EvaluateMacroString(fmt::format("${{Me.Gem[{}].ID}}", gem)), 0) == 0)
+			return gem;
+	}
+
+	return 0;
+}
+
+// Casts a teleport spell, memorizing it first if it is only in the spellbook.
+static void CastTeleportSpell(std::string spell)
+{
+	s_pendingTeleportSpell.clear();
+
+	if (GetBoolFromString(EvaluateMacroString(fmt::format("${{Me.Gem[{}]}}", spell)), false))
+	{
+		SPDLOG_INFO("Casting \ag{}", spell);
+		DoCommand(pLocalPlayer, fmt::format("/cast \"{}\"", spell).c_str());
+		return;
+	}
+
+	if (!GetBoolFromString(EvaluateMacroString(fmt::format("${{Me.Book[{}]}}", spell)), false))
+	{
+		SPDLOG_ERROR("Cannot cast \ag{}\ax, it is not in your spellbook", spell);
+		return;
+	}
+
+	// Use an empty gem if there is one, otherwise the last gem has to make room.
+	int gem = FindEmptySpellGem();
+	if (gem == 0)
+	{
+		gem = GetIntFromString(EvaluateMacroString("${Me.NumGems}"), 8);
+
+		SPDLOG_WARN("No empty spell gem, replacing \ag{}\ax in gem {} with \ag{}",
+			EvaluateMacroString(fmt::format("${{Me.Gem[{}].Name}}", gem)), gem, spell);
+	}
+
+	SPDLOG_INFO("Memorizing \ag{}\ax to cast it", spell);
+	DoCommand(pLocalPlayer, fmt::format("/memspell {} \"{}\"", gem, spell).c_str());
+
+	s_pendingTeleportSpell = std::move(spell);
+	s_pendingTeleportSpellTimeout = std::chrono::steady_clock::now() + PendingTeleportSpellTimeout;
+}
+
+void ZonePath_CastTeleportSpell(const ParsedTeleport& teleport)
+{
+	if (!teleport.spell.empty())
+		CastTeleportSpell(teleport.spell);
+}
+
+// Casts a spell that a group member asked for. It comes from a group command, so only spells of
+// teleports that we are able to cast are accepted, and the configured spell name is what gets cast.
+void ZonePath_CastRequestedTeleportSpell(std::string_view spell)
+{
+	if (!g_zoneConnections || !pLocalPC)
+		return;
+
+	std::string className = EvaluateMacroString("${Me.Class.ShortName}");
+	int level = GetIntFromString(EvaluateMacroString("${Me.Level}"), 0);
+
+	for (const ParsedTeleport& teleport : g_zoneConnections->GetTeleports())
+	{
+		if (teleport.spell.empty() || !ci_equals(teleport.spell, spell) || level < teleport.level)
+			continue;
+
+		if (!teleport.classes.empty() && std::none_of(teleport.classes.begin(), teleport.classes.end(),
+			[&](const std::string& c) { return ci_equals(c, className); }))
+		{
+			continue;
+		}
+
+		ZonePath_CastTeleportSpell(teleport);
+		return;
+	}
+
+	SPDLOG_WARN("Ignoring request to cast \ag{}\ax, it is not a teleport spell you can cast", spell);
+}
+
+static void UpdatePendingTeleportSpell()
+{
+	if (s_pendingTeleportSpell.empty())
+		return;
+
+	if (GetBoolFromString(EvaluateMacroString(fmt::format("${{Me.SpellReady[{}]}}", s_pendingTeleportSpell)), false))
+	{
+		CastTeleportSpell(s_pendingTeleportSpell);
+	}
+	else if (std::chrono::steady_clock::now() > s_pendingTeleportSpellTimeout)
+	{
+		SPDLOG_ERROR("Timed out waiting to cast \ag{}", s_pendingTeleportSpell);
+		s_pendingTeleportSpell.clear();
+	}
+}
+
 void ZonePath_OnPulse()
 {
+	ZonePath_UpdateRequirements();
+	ZonePath_UpdateRoutingTable();
+	UpdatePendingTeleportSpell();
+	DrainPathCompletions();
+
 	if (s_currentZone != pLocalPC->zoneId)
 	{
 		UpdateForZoneChange();
@@ -388,6 +1115,11 @@ void ZonePath_NavCanceled(bool message)
 {
 	if (s_travelToActive)
 	{
+		// Nav failing to reach a connection means it is broken, so fall back to another route.
+		// Nav being stopped is taken to mean that the user wants to stop.
+		if (!message && SwitchToAlternative(GetNextZone()))
+			return;
+
 		StopTravelTo(false);
 		if (message)
 		{
@@ -400,7 +1132,9 @@ void ZonePath_Stop()
 {
 	ZoneGuideManagerClient& zoneGuide = ZoneGuideManagerClient::Instance();
 
-	bool isActive = s_travelToActive || !s_activeZonePathRequest.zonePath.empty() || !zoneGuide.activePath.IsEmpty();
+	// A path that is still being generated counts too. Stopping drops it.
+	bool isActive = s_travelToActive || !s_activeZonePathRequest.zonePath.empty() || !zoneGuide.activePath.IsEmpty()
+		|| HasPendingActivation();
 
 	if (isActive)
 	{
@@ -415,166 +1149,101 @@ void ZonePath_Stop()
 	Navigation_Stop();
 }
 
-namespace YAML
+// The zone guide is streamed straight to the dump file, rather than built up as a node tree first.
+static void EmitZoneGuideConnection(YAML::Emitter& out, const ZoneGuideConnection& connection)
 {
-	template <>
-	struct convert<CXStr>
-	{
-		static Node encode(const CXStr& str)
-		{
-			YAML::Node node(NodeType::Scalar);
-			node = std::string{ str };
-
-			return node;
-		}
-
-		static bool decode(const Node& node, CXStr& str)
-		{
-			if (!node.IsScalar())
-				return false;
-
-			try {
-				str = node.as<std::string>();
-			}
-			catch (const YAML::BadConversion&) {
-				return false;
-			}
-			return true;
-		}
-	};
-
-	template <>
-	struct convert<ZoneGuideConnection>
-	{
-		static Node encode(const ZoneGuideConnection& zone)
-		{
-			YAML::Node node;
-			node["DestZoneId"] = (int)zone.destZoneId;
-			node["DestZone"] = GetShortZone((int)zone.destZoneId);
-			node["TransferType"] = ZoneGuideManagerClient::Instance().GetZoneTransferTypeNameByIndex(zone.transferTypeIndex);
-			if (zone.requiredExpansions != 0)
-				node["RequiredExpansion"] = GetHighestExpansionOwnedName((EQExpansionOwned)zone.requiredExpansions);
-
-			return node;
-		}
+	ZoneGuideManagerClient& mgr = ZoneGuideManagerClient::Instance();
 
-		static bool decode(const Node& node, ZoneGuideConnection& zone)
-		{
-			return false;
-		}
-	};
+	out << YAML::BeginMap;
+	out << YAML::Key << "DestZoneId" << YAML::Value << (int)connection.destZoneId;
+	out << YAML::Key << "DestZone" << YAML::Value << GetShortZone((int)connection.destZoneId);
+	out << YAML::Key << "TransferType" << YAML::Value << std::string{ mgr.GetZoneTransferTypeNameByIndex(connection.transferTypeIndex) };
+	if (connection.requiredExpansions != 0)
+		out << YAML::Key << "RequiredExpansion" << YAML::Value << GetHighestExpansionOwnedName((EQExpansionOwned)connection.requiredExpansions);
+	out << YAML::EndMap;
+}
 
-	template <>
-	struct convert<ZoneGuideContinent>
+static void EmitZoneGuideZone(YAML::Emitter& out, const ZoneGuideZone& zone)
+{
+	ZoneGuideManagerClient& mgr = ZoneGuideManagerClient::Instance();
+	EQZoneInfo* pZoneInfo = pWorldData->GetZone(zone.zoneId);
+
+	out << YAML::BeginMap;
+	out << YAML::Key << "ZoneId" << YAML::Value << zone.zoneId;
+	out << YAML::Key << "Name" << YAML::Value << (pZoneInfo ? pZoneInfo->LongName : "Unknown");
+	out << YAML::Key << "ShortName" << YAML::Value << (pZoneInfo ? pZoneInfo->ShortName : "Unknown");
+	out << YAML::Key << "Continent" << YAML::Value << std::string{ mgr.GetContinentNameByIndex(zone.continentIndex) };
+	out << YAML::Key << "MinLevel" << YAML::Value << zone.minLevel;
+	out << YAML::Key << "MaxLevel" << YAML::Value << zone.maxLevel;
+
+	out << YAML::Key << "Types" << YAML::Value << YAML::BeginSeq;
+	for (int i = 0; i < zone.types.GetNumBits(); ++i)
 	{
-		static Node encode(const ZoneGuideContinent& zone)
-		{
-			YAML::Node node;
-			node["Id"] = zone.id;
-			node["Name"] = zone.name;
+		if (zone.types.IsBitSet(i))
+			out << std::string{ mgr.GetZoneTypeNameByIndex(i) };
+	}
+	out << YAML::EndSeq;
 
-			return node;
-		}
+	out << YAML::Key << "Connections" << YAML::Value << YAML::BeginSeq;
+	for (const ZoneGuideConnection& connection : zone.zoneConnections)
+		EmitZoneGuideConnection(out, connection);
+	out << YAML::EndSeq;
 
-		static bool decode(const Node& node, ZoneGuideContinent& zone)
-		{
-			return false;
-		}
-	};
+	out << YAML::EndMap;
+}
 
-	template <>
-	struct convert<ZoneGuideZoneType>
+std::shared_ptr<const ZoneGuideSnapshot> ZoneGuideSnapshot::LoadDump(const std::string& fileName)
+{
+	try
 	{
-		static Node encode(const ZoneGuideZoneType& zone)
-		{
-			YAML::Node node;
-			node["Id"] = zone.id;
-			node["DisplaySequence"] = zone.displaySequence;
-			node["Name"] = zone.name;
+		YAML::Node node = YAML::LoadFile(fileName);
+		auto snapshot = std::make_shared<ZoneGuideSnapshot>();
 
-			return node;
-		}
+		// Transfer types are dumped in index order, and connections refer to them by name.
+		for (const YAML::Node& transferType : node["TransferTypes"])
+			snapshot->transferTypes.push_back(transferType["Description"].as<std::string>(std::string()));
 
-		static bool decode(const Node& node, ZoneGuideZoneType& zone)
-		{
-			return false;
-		}
-	};
+		std::vector<std::string> continents;
+		for (const YAML::Node& continent : node["Continents"])
+			continents.push_back(continent["Name"].as<std::string>(std::string()));
 
-	template <>
-	struct convert<ZoneGuideTransferType>
-	{
-		static Node encode(const ZoneGuideTransferType& zone)
+		for (const YAML::Node& zoneNode : node["Zones"])
 		{
-			YAML::Node node;
-			node["Id"] = zone.id;
-			node["Description"] = zone.description;
+			Zone zone;
+			zone.zoneId = zoneNode["ZoneId"].as<int>(0);
+			zone.minLevel = zoneNode["MinLevel"].as<int>(0);
+			zone.maxLevel = zoneNode["MaxLevel"].as<int>(0);
 
-			return node;
-		}
-
-		static bool decode(const Node& node, ZoneGuideTransferType& zone)
-		{
-			return false;
-		}
-	};
-
-	template <typename T>
-	struct convert<ArrayClass<T>> {
-		static Node encode(const ArrayClass<T>& arr) {
-			Node node(NodeType::Sequence);
-			for (const T& value : arr)
-				node.push_back(value);
-			return node;
-		}
-
-		static bool decode(const Node& node, ArrayClass<T>& arr) {
-			return false;
-		}
-	};
-
-	template <>
-	struct convert<ZoneGuideZone>
-	{
-		static Node encode(const ZoneGuideZone& zone)
-		{
-			YAML::Node node;
-			node["ZoneId"] = zone.zoneId;
+			auto continent = std::find(continents.begin(), continents.end(), zoneNode["Continent"].as<std::string>(std::string()));
+			if (continent != continents.end())
+				zone.continentIndex = (int)(continent - continents.begin());
 
-			EQZoneInfo* pZoneInfo = pWorldData->GetZone(zone.zoneId);
-			if (pZoneInfo)
+			for (const YAML::Node& connectionNode : zoneNode["Connections"])
 			{
-				node["Name"] = pZoneInfo->LongName;
-				node["ShortName"] = pZoneInfo->ShortName;
-			}
-			else
-			{
-				node["Name"] = "Unknown";
-				node["ShortName"] = "Unknown";
-			}
-			node["Continent"] = ZoneGuideManagerClient::Instance().GetContinentNameByIndex(zone.continentIndex);
-			node["MinLevel"] = zone.minLevel;
-			node["MaxLevel"] = zone.maxLevel;
+				ZoneGuideConnection& connection = zone.connections.emplace_back();
+				connection.destZoneId = connectionNode["DestZoneId"].as<int>(0);
+				connection.transferTypeIndex = snapshot->FindTransferType(connectionNode["TransferType"].as<std::string>(std::string()));
 
-			std::vector<std::string> types;
-			for (int i = 0; i < zone.types.GetNumBits(); ++i)
-			{
-				if (zone.types.IsBitSet(i))
+				std::string expansionName = connectionNode["RequiredExpansion"].as<std::string>(std::string());
+				if (!expansionName.empty())
 				{
-					types.push_back(std::string(ZoneGuideManagerClient::Instance().GetZoneTypeNameByIndex(i)));
+					int expansionNum = GetExpansionNumber(expansionName);
+					if (expansionNum > 0)
+						connection.requiredExpansions = (EQExpansionOwned)EQ_EXPANSION(expansionNum);
 				}
 			}
-			node["Types"] = types;
-			node["Connections"] = zone.zoneConnections;
 
-			return node;
+			snapshot->AddZone(std::move(zone));
 		}
 
-		static bool decode(const Node& node, ZoneGuideZone& zone)
-		{
-			return false;
-		}
-	};
+		return snapshot;
+	}
+	catch (const YAML::Exception& ex)
+	{
+		SPDLOG_ERROR("Failed to load zone guide from {}: {}", fileName, ex.what());
+	}
+
+	return nullptr;
 }
 
 void ZonePath_DumpConnections()
@@ -582,36 +1251,95 @@ void ZonePath_DumpConnections()
 	// Dump all the connection data from the ZoneGuideManager
 	ZoneGuideManagerClient& mgr = ZoneGuideManagerClient::Instance();
 
+	SPDLOG_INFO("Dumping zone connections from ZoneGuideManager...");
+
+	std::filesystem::path outputFile = std::filesystem::path(gPathResources) / "ZoneGuide.yaml";
+	std::filesystem::path tempFile = outputFile;
+	tempFile += ".tmp";
+
 	try
 	{
-		SPDLOG_INFO("Dumping zone connections from ZoneGuideManager...");
+		auto startTime = std::chrono::steady_clock::now();
 
-		std::string outputFile = (std::filesystem::path(gPathResources) / "ZoneGuide.yaml").string();
+		// Write to a temporary file and move it into place once it is complete, so that a failed
+		// dump never leaves a partial file behind.
+		{
+			std::ofstream file(tempFile, std::ios::out | std::ios::trunc);
+			if (!file)
+			{
+				WriteChatf("\arError: Could not open %s for writing", tempFile.string().c_str());
+				return;
+			}
 
-		YAML::Node node;
-		node["Continents"] = mgr.continents;
-		node["ZoneTypes"] = mgr.zoneTypes;
-		node["TransferTypes"] = mgr.transferTypes;
+			YAML::Emitter out(file);
+			out.SetIndent(4);
+			out.SetFloatPrecision(3);
+			out.SetDoublePrecision(3);
 
-		std::vector<ZoneGuideZone> zones;
-		for (const ZoneGuideZone& zone : mgr.zones)
-		{
-			if (zone.zoneId != 0)
-				zones.push_back(zone);
+			out << YAML::BeginMap;
+
+			out << YAML::Key << "Continents" << YAML::Value << YAML::BeginSeq;
+			for (const ZoneGuideContinent& continent : mgr.continents)
+			{
+				out << YAML::BeginMap;
+				out << YAML::Key << "Id" << YAML::Value << continent.id;
+				out << YAML::Key << "Name" << YAML::Value << std::string{ continent.name };
+				out << YAML::EndMap;
+			}
+			out << YAML::EndSeq;
+
+			out << YAML::Key << "ZoneTypes" << YAML::Value << YAML::BeginSeq;
+			for (const ZoneGuideZoneType& zoneType : mgr.zoneTypes)
+			{
+				out << YAML::BeginMap;
+				out << YAML::Key << "Id" << YAML::Value << zoneType.id;
+				out << YAML::Key << "DisplaySequence" << YAML::Value << zoneType.displaySequence;
+				out << YAML::Key << "Name" << YAML::Value << std::string{ zoneType.name };
+				out << YAML::EndMap;
+			}
+			out << YAML::EndSeq;
+
+			out << YAML::Key << "TransferTypes" << YAML::Value << YAML::BeginSeq;
+			for (const ZoneGuideTransferType& transferType : mgr.transferTypes)
+			{
+				out << YAML::BeginMap;
+				out << YAML::Key << "Id" << YAML::Value << transferType.id;
+				out << YAML::Key << "Description" << YAML::Value << std::string{ transferType.description };
+				out << YAML::EndMap;
+			}
+			out << YAML::EndSeq;
+
+			out << YAML::Key << "Zones" << YAML::Value << YAML::BeginSeq;
+			for (const ZoneGuideZone& zone : mgr.zones)
+			{
+				if (zone.zoneId != 0)
+					EmitZoneGuideZone(out, zone);
+			}
+			out << YAML::EndSeq;
+
+			out << YAML::EndMap;
+			file << "\n";
+
+			if (!out.good() || !file.flush())
+			{
+				WriteChatf("\arError: Failed to write zone connections: %s",
+					out.good() ? "could not write to file" : out.GetLastError().c_str());
+				file.close();
+				std::filesystem::remove(tempFile);
+				return;
+			}
 		}
-		node["Zones"] = zones;
 
-		YAML::Emitter out;
-		out.SetIndent(4);
-		out.SetFloatPrecision(3);
-		out.SetDoublePrecision(3);
-		out << node;
+		std::filesystem::rename(tempFile, outputFile);
 
-		std::fstream file(outputFile, std::ios::out);
-		file << out.c_str();
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+		SPDLOG_INFO("Wrote zone connections to \ay{}\ax in \ay{:.2f}\ax ms", outputFile.string(), elapsed.count());
 	}
 	catch (const std::exception& exc)
 	{
 		WriteChatf("\arError: %s", exc.what());
+
+		std::error_code ec;
+		std::filesystem::remove(tempFile, ec);
 	}
 }
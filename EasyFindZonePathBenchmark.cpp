@@ -0,0 +1,652 @@
+
+#include "EasyFind.h"
+#include "EasyFindConfiguration.h"
+#include "EasyFindZoneConnections.h"
+#include "EasyFindZoneContraction.h"
+#include "EasyFindZoneGraph.h"
+#include "EasyFindZoneHierarchy.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+// The original breadth-first search over the ZoneGuideManagerClient, kept as the baseline
+// that the zone graph is measured against.
+static std::vector<ZonePathNode> GeneratePath_Reference(EQZoneIndex fromZone, EQZoneIndex toZone,
+	std::string& outputMessage)
+{
+	ZoneGuideManagerClient& zoneMgr = ZoneGuideManagerClient::Instance();
+
+	if (fromZone == toZone)
+	{
+		outputMessage = "Already at target zone";
+		return {};
+	}
+
+	EQZoneInfo* toZoneInfo = pWorldData->GetZone(toZone);
+	if (!toZoneInfo)
+	{
+		outputMessage = "Ending zone is not valid";
+		return {};
+	}
+
+	EQZoneInfo* fromZoneInfo = pWorldData->GetZone(fromZone);
+	if (!fromZoneInfo)
+	{
+		outputMessage = "Starting zone is not valid";
+		return {};
+	}
+
+	// Implements a breadth-first search of the zone connections
+	EQZoneIndex currentZoneId = pWorldData->GetZoneBaseId(fromZone);
+	std::deque<EQZoneIndex> queue;
+	struct ZonePathGenerationData {
+		int depth = -1;
+		int pathMinLevel = -1;
+		int prevZoneTransferTypeIndex = -1;
+		EQZoneIndex prevZone = 0;
+
+		// information about the origin of this link
+		const ParsedFindableLocation* location = nullptr;
+		const ZoneGuideConnection* connection = nullptr;
+	};
+	std::unordered_map<EQZoneIndex, ZonePathGenerationData> pathData;
+
+	queue.push_back(currentZoneId);
+	pathData[fromZone].depth = 0;
+	pathData[fromZone].pathMinLevel = 0;
+
+	if (const ZoneGuideZone* z = zoneMgr.GetZone(currentZoneId))
+		pathData[fromZone].pathMinLevel = z->minLevel;
+
+	auto addTransfer = [&](EQZoneIndex destZoneId, int transferTypeIndex, int minLevel,
+		const ParsedFindableLocation* location, const ZoneGuideConnection* connection)
+	{
+		auto& data = pathData[destZoneId];
+		auto& prevData = pathData[currentZoneId];
+
+		data.location = location;
+		data.connection = connection;
+
+		if (data.depth == -1)
+		{
+			queue.push_back(destZoneId);
+
+			data.prevZoneTransferTypeIndex = transferTypeIndex;
+			data.prevZone = currentZoneId;
+			data.pathMinLevel = std::max(prevData.pathMinLevel, minLevel);
+
+			data.depth = prevData.depth + 1;
+		}
+		else if (data.prevZone && (data.depth == prevData.depth + 1)
+			&& pathData[data.prevZone].pathMinLevel > prevData.pathMinLevel)
+		{
+			// lower level preference?
+			data.prevZoneTransferTypeIndex = transferTypeIndex;
+			data.prevZone = currentZoneId;
+			data.pathMinLevel = std::max(prevData.pathMinLevel, minLevel);
+		}
+	};
+
+	int otherIndex = FindTransferIndexByName("Other");
+	int zoneLineIndex = FindTransferIndexByName("Zone Line");
+	int translocatorIndex = FindTransferIndexByName("Translocator");
+
+	// Explore the zone graph and cost everything out.
+	while (!queue.empty())
+	{
+		currentZoneId = queue.front();
+		queue.pop_front();
+
+		// Did we find a connection to the destination?
+		if (pathData[toZone].depth > -1 && pathData[toZone].depth < pathData[currentZoneId].depth)
+		{
+			break;
+		}
+
+		const EZZoneData& ezZoneData = g_zoneConnections->GetZoneData(currentZoneId);
+
+		if (ZoneGuideZone* currentZone = zoneMgr.GetZone(currentZoneId))
+		{
+			// Search the zone guide with modified parameters.
+			for (const ZoneGuideConnection& connection : currentZone->zoneConnections)
+			{
+				// Skip connection if it is disabled by the user.
+				if (connection.disabled)
+					continue;
+
+				// Make sure that progression server expansion is available.
+				if (connection.requiredExpansions != 0 && pEverQuestInfo->bProgressionServer)
+				{
+					if ((pEverQuestInfo->ProgressionOpenExpansions & connection.requiredExpansions) != connection.requiredExpansions)
+						continue;
+				}
+
+				// Make sure we didn't remove this connection
+				if (std::find(ezZoneData.removedConnections.begin(), ezZoneData.removedConnections.end(), connection.destZoneId) != ezZoneData.removedConnections.end())
+					continue;
+
+				// Make sure that the transfer types are supported
+				if (g_configuration->IsDisabledTransferType(connection.transferTypeIndex))
+					continue;
+
+				addTransfer(connection.destZoneId, connection.transferTypeIndex, currentZone->minLevel, nullptr, &connection);
+				continue;
+			}
+		}
+
+		// Search our own connections
+		for (const ParsedFindableLocation& location : ezZoneData.findableLocations)
+		{
+			if (!location.IsZoneConnection())
+				continue;
+
+			if (!location.CheckRequirements())
+				continue;
+
+			int transferTypeIndex = otherIndex;
+
+			if (location.type == LocationType::Location)
+				transferTypeIndex = zoneLineIndex;
+			else if (location.type == LocationType::Translocator)
+				transferTypeIndex = translocatorIndex;
+
+			if (location.zoneId != 0)
+				addTransfer(location.zoneId, transferTypeIndex, 0, &location, nullptr);
+			for (const auto& dest : location.translocatorDestinations)
+			{
+				if (dest.zoneId != 0)
+					addTransfer(dest.zoneId, translocatorIndex, 0, &location, nullptr);
+			}
+		}
+	}
+
+	// Work backwards from the destination and build the route.
+	EQZoneIndex zoneId = toZone;
+	int transferTypeIndex = -1;
+	const ParsedFindableLocation* location = nullptr;
+	const ZoneGuideConnection* connection = nullptr;
+
+	std::vector<ZonePathNode> reversedPath;
+
+	while (zoneId != 0)
+	{
+		reversedPath.emplace_back(zoneId, transferTypeIndex, location ? location->zoneIdentifier : 0, connection);
+
+		transferTypeIndex = pathData[zoneId].prevZoneTransferTypeIndex;
+		zoneId = pathData[zoneId].prevZone;
+		location = pathData[zoneId].location;
+		connection = pathData[zoneId].connection;
+	}
+
+	if (reversedPath.size() <= 1)
+	{
+		outputMessage = "Could not find path to target zone.";
+	}
+
+	std::vector<ZonePathNode> newPath;
+	newPath.reserve(reversedPath.size());
+
+	// If we made it back to the start, then flip the list around and return it.
+	if (!reversedPath.empty() && reversedPath.back().zoneId == fromZone)
+	{
+		for (auto riter = reversedPath.rbegin(); riter != reversedPath.rend(); ++riter)
+		{
+			newPath.push_back(*riter);
+		}
+	}
+
+	return newPath;
+}
+
+void ZonePath_Benchmark()
+{
+	constexpr int QueryCount = 1000;
+	using Clock = std::chrono::steady_clock;
+
+	if (!pWorldData)
+	{
+		SPDLOG_WARN("Zone data is not available, try again later...");
+		return;
+	}
+
+	auto buildStart = Clock::now();
+	std::shared_ptr<const ZoneGraph> graph = ZoneGraph::Build();
+	std::chrono::duration<double, std::milli> buildTime = Clock::now() - buildStart;
+
+	if (!graph || graph->GetNodeCount() < 2)
+	{
+		SPDLOG_WARN("Zone graph is empty, nothing to benchmark.");
+		return;
+	}
+
+	// Use a fixed seed so that runs are comparable.
+	std::mt19937 rng(12345);
+	std::uniform_int_distribution<int> dist(0, graph->GetNodeCount() - 1);
+
+	std::vector<std::pair<EQZoneIndex, EQZoneIndex>> queries;
+	queries.reserve(QueryCount);
+
+	while ((int)queries.size() < QueryCount)
+	{
+		EQZoneIndex fromZone = graph->GetNode((ZoneOrdinal)dist(rng)).zoneId;
+		EQZoneIndex toZone = graph->GetNode((ZoneOrdinal)dist(rng)).zoneId;
+
+		if (fromZone != toZone && pWorldData->GetZone(fromZone) && pWorldData->GetZone(toZone))
+			queries.emplace_back(fromZone, toZone);
+	}
+
+	// Make sure the shared graph is built before we start timing.
+	ZonePath_FinishGraphBuild();
+
+	std::vector<size_t> referenceLengths(queries.size());
+	std::string message;
+
+	auto referenceStart = Clock::now();
+	for (size_t i = 0; i < queries.size(); ++i)
+		referenceLengths[i] = GeneratePath_Reference(queries[i].first, queries[i].second, message).size();
+	std::chrono::duration<double, std::micro> referenceTime = Clock::now() - referenceStart;
+
+	int mismatches = 0;
+
+	// Start cold, so that the first pass measures generating routes and the second measures the cache.
+	ZonePath_ClearRouteCache();
+
+	auto graphStart = Clock::now();
+	for (size_t i = 0; i < queries.size(); ++i)
+	{
+		if (ZonePath_GeneratePath(queries[i].first, queries[i].second, message).size() != referenceLengths[i])
+			++mismatches;
+	}
+	std::chrono::duration<double, std::micro> graphTime = Clock::now() - graphStart;
+
+	ZoneRouteCacheStats statsBefore = ZonePath_GetRouteCacheStats();
+
+	auto cachedStart = Clock::now();
+	for (const auto& [fromZone, toZone] : queries)
+		ZonePath_GeneratePath(fromZone, toZone, message);
+	std::chrono::duration<double, std::micro> cachedTime = Clock::now() - cachedStart;
+
+	ZoneRouteCacheStats statsAfter = ZonePath_GetRouteCacheStats();
+
+	// Compare one way and bidirectional searches directly on the graph.
+	ZonePathRoutingMode mode = g_configuration->GetRoutingMode();
+	ZoneEdgeMask edgeMask = graph->EvaluateRequirements();
+	std::vector<ZonePathNode> path;
+	int64_t forwardExpanded = 0;
+	int64_t bidirectionalExpanded = 0;
+	int bidirectionalMismatches = 0;
+
+	auto forwardStart = Clock::now();
+	for (const auto& [fromZone, toZone] : queries)
+	{
+		int expanded = 0;
+		graph->FindPath(graph->GetOrdinal(pWorldData->GetZoneBaseId(fromZone)), graph->GetOrdinal(toZone), mode, edgeMask, path, &expanded);
+		forwardExpanded += expanded;
+	}
+	std::chrono::duration<double, std::micro> forwardTime = Clock::now() - forwardStart;
+
+	auto bidirectionalStart = Clock::now();
+	for (size_t i = 0; i < queries.size(); ++i)
+	{
+		int expanded = 0;
+		graph->FindPathBidirectional(graph->GetOrdinal(pWorldData->GetZoneBaseId(queries[i].first)),
+			graph->GetOrdinal(queries[i].second), mode, edgeMask, path, &expanded);
+		bidirectionalExpanded += expanded;
+
+		if (mode == ZonePathRoutingMode::FewestZones && path.size() != referenceLengths[i])
+			++bidirectionalMismatches;
+	}
+	std::chrono::duration<double, std::micro> bidirectionalTime = Clock::now() - bidirectionalStart;
+
+	// Compare the continent hierarchy against the flat search it stands in for.
+	std::shared_ptr<const ZoneHierarchy> hierarchy = ZoneHierarchy::Build(graph, mode, std::make_shared<ZoneEdgeMask>(edgeMask));
+	int64_t hierarchyExpanded = 0;
+	int hierarchyMismatches = 0;
+	int hierarchyFallbacks = 0;
+	std::chrono::duration<double, std::micro> hierarchyTime{ 0 };
+
+	if (hierarchy)
+	{
+		auto hierarchyStart = Clock::now();
+		for (size_t i = 0; i < queries.size(); ++i)
+		{
+			int expanded = 0;
+			if (!hierarchy->FindPath(graph->GetOrdinal(pWorldData->GetZoneBaseId(queries[i].first)),
+				graph->GetOrdinal(queries[i].second), path, &expanded))
+			{
+				++hierarchyFallbacks;
+				continue;
+			}
+
+			hierarchyExpanded += expanded;
+
+			if (mode == ZonePathRoutingMode::FewestZones && path.size() != referenceLengths[i])
+				++hierarchyMismatches;
+		}
+		hierarchyTime = Clock::now() - hierarchyStart;
+	}
+
+	// Same for the contraction hierarchy.
+	std::shared_ptr<const ZoneContraction> contraction = ZoneContraction::Build(graph);
+	std::shared_ptr<const ZoneContractionMetric> contractionMetric = ZoneContractionMetric::Customize(contraction, mode,
+		std::make_shared<ZoneEdgeMask>(edgeMask));
+	int64_t contractionExpanded = 0;
+	int contractionMismatches = 0;
+	int contractionFallbacks = 0;
+	std::chrono::duration<double, std::micro> contractionTime{ 0 };
+
+	if (contractionMetric)
+	{
+		auto contractionStart = Clock::now();
+		for (size_t i = 0; i < queries.size(); ++i)
+		{
+			int expanded = 0;
+			if (!contractionMetric->FindPath(graph->GetOrdinal(pWorldData->GetZoneBaseId(queries[i].first)),
+				graph->GetOrdinal(queries[i].second), path, &expanded))
+			{
+				++contractionFallbacks;
+				continue;
+			}
+
+			contractionExpanded += expanded;
+
+			if (mode == ZonePathRoutingMode::FewestZones && path.size() != referenceLengths[i])
+				++contractionMismatches;
+		}
+		contractionTime = Clock::now() - contractionStart;
+	}
+
+	// The bottleneck search should cost about the same as breadth-first search.
+	auto timeMode = [&](ZonePathRoutingMode searchMode)
+	{
+		auto start = Clock::now();
+		for (const auto& [fromZone, toZone] : queries)
+		{
+			graph->FindPath(graph->GetOrdinal(pWorldData->GetZoneBaseId(fromZone)), graph->GetOrdinal(toZone),
+				searchMode, edgeMask, path);
+		}
+
+		return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / queries.size();
+	};
+
+	double fewestZonesPerQuery = timeMode(ZonePathRoutingMode::FewestZones);
+	double lowestLevelPerQuery = timeMode(ZonePathRoutingMode::LowestLevel);
+
+	double referencePerQuery = referenceTime.count() / queries.size();
+	double graphPerQuery = graphTime.count() / queries.size();
+
+	SPDLOG_INFO("Zone graph: \ay{}\ax zones, \ay{}\ax connections, built in \ay{:.2f}\ax ms",
+		graph->GetNodeCount(), graph->GetEdgeCount(), buildTime.count());
+
+	std::shared_ptr<const ZoneRoutingTable> routingTable = ZoneRoutingTable::Build(graph, mode,
+		std::make_shared<ZoneEdgeMask>(edgeMask));
+	SPDLOG_INFO("Routing table: built in \ay{:.2f}\ax ms on \ay{}\ax threads", routingTable->GetBuildTime(),
+		routingTable->GetBuildThreadCount());
+	SPDLOG_INFO("{} queries: reference \ay{:.2f}\ax us/query, {} \ay{:.2f}\ax us/query (\ag{:.1f}x\ax)",
+		queries.size(), referencePerQuery, ZonePath_GetRoutingTable() ? "routing table" : "zone graph",
+		graphPerQuery, graphPerQuery > 0 ? referencePerQuery / graphPerQuery : 0.0);
+
+	SPDLOG_INFO("Cached queries: \ay{:.2f}\ax us/query, \ay{}\ax hits, \ay{}\ax misses",
+		cachedTime.count() / queries.size(), statsAfter.hits - statsBefore.hits, statsAfter.misses - statsBefore.misses);
+	SPDLOG_INFO("One way search \ay{:.2f}\ax us/query, \ay{:.1f}\ax zones expanded. Bidirectional search \ay{:.2f}\ax us/query, \ay{:.1f}\ax zones expanded",
+		forwardTime.count() / queries.size(), (double)forwardExpanded / queries.size(),
+		bidirectionalTime.count() / queries.size(), (double)bidirectionalExpanded / queries.size());
+
+	if (hierarchy)
+	{
+		SPDLOG_INFO("Continent hierarchy: \ay{}\ax continents, \ay{}\ax gateways, \ay{}\ax overlay edges, \ay{:.1f}\ax KB (routing table \ay{:.1f}\ax KB)",
+			hierarchy->GetContinentCount(), hierarchy->GetGatewayCount(), hierarchy->GetOverlayEdgeCount(),
+			hierarchy->GetMemoryUsage() / 1024.0, routingTable->GetMemoryUsage() / 1024.0);
+		SPDLOG_INFO("Hierarchical search \ay{:.2f}\ax us/query, \ay{:.1f}\ax zones expanded, \ay{}\ax fell back to the flat search",
+			hierarchyTime.count() / queries.size(), (double)hierarchyExpanded / queries.size(), hierarchyFallbacks);
+	}
+	else
+	{
+		SPDLOG_INFO("Continent hierarchy is not available for this routing mode or zone data");
+	}
+
+	if (contractionMetric)
+	{
+		SPDLOG_INFO("Contraction: \ay{}\ax shortcuts, contracted in \ay{:.2f}\ax ms, customized in \ay{:.2f}\ax ms, \ay{:.1f}\ax KB",
+			contraction->GetShortcutCount(), contraction->GetBuildTime(), contractionMetric->GetCustomizeTime(),
+			(contraction->GetMemoryUsage() + contractionMetric->GetMemoryUsage()) / 1024.0);
+		SPDLOG_INFO("Contraction search \ay{:.2f}\ax us/query, \ay{:.1f}\ax zones expanded, \ay{}\ax fell back to the flat search",
+			contractionTime.count() / queries.size(), (double)contractionExpanded / queries.size(), contractionFallbacks);
+	}
+	else
+	{
+		SPDLOG_INFO("Contraction is not available for this routing mode");
+	}
+
+	SPDLOG_INFO("Fewest zones search \ay{:.2f}\ax us/query, lowest level search \ay{:.2f}\ax us/query",
+		fewestZonesPerQuery, lowestLevelPerQuery);
+
+	if (bidirectionalMismatches > 0)
+		SPDLOG_WARN("{} bidirectional queries produced a different route length than the reference search", bidirectionalMismatches);
+
+	if (hierarchyMismatches > 0)
+		SPDLOG_WARN("{} hierarchical queries produced a different route length than the reference search", hierarchyMismatches);
+
+	if (contractionMismatches > 0)
+		SPDLOG_WARN("{} contraction queries produced a different route length than the reference search", contractionMismatches);
+
+	// Other routing modes are allowed to trade extra zones for a better route.
+	if (mismatches > 0 && g_configuration->GetRoutingMode() == ZonePathRoutingMode::FewestZones)
+		SPDLOG_WARN("{} queries produced a different route length than the reference search", mismatches);
+}
+
+//============================================================================
+
+// Results of a benchmark suite run, also saved as the baseline to compare later runs against.
+struct ZonePathSuiteResults
+{
+	std::string source;
+	int queries = 0;
+	double p50 = 0;                                       // microseconds
+	double p99 = 0;
+	double nodesExpanded = 0;                             // per query
+};
+
+static std::string GetBenchmarkBaselineFile()
+{
+	return (std::filesystem::path(gPathResources) / "ZonePathBenchmark.yaml").string();
+}
+
+static bool LoadBenchmarkBaseline(ZonePathSuiteResults& results)
+{
+	try
+	{
+		YAML::Node node = YAML::LoadFile(GetBenchmarkBaselineFile());
+
+		results.source = node["Source"].as<std::string>(std::string());
+		results.queries = node["Queries"].as<int>(0);
+		results.p50 = node["P50"].as<double>(0);
+		results.p99 = node["P99"].as<double>(0);
+		results.nodesExpanded = node["NodesExpanded"].as<double>(0);
+
+		return results.queries > 0;
+	}
+	catch (const YAML::Exception&)
+	{
+		return false;
+	}
+}
+
+static void SaveBenchmarkBaseline(const ZonePathSuiteResults& results)
+{
+	YAML::Node node;
+	node["Source"] = results.source;
+	node["Queries"] = results.queries;
+	node["P50"] = results.p50;
+	node["P99"] = results.p99;
+	node["NodesExpanded"] = results.nodesExpanded;
+
+	YAML::Emitter out;
+	out << node;
+
+	std::fstream file(GetBenchmarkBaselineFile(), std::ios::out);
+	file << out.c_str();
+}
+
+void ZonePath_BenchmarkSuite(std::string_view args)
+{
+	constexpr int SampledQueryCount = 10000;
+	constexpr double DefaultRegressionThreshold = 20.0;    // percent
+	using Clock = std::chrono::steady_clock;
+
+	bool useDump = false;
+	bool allPairs = false;
+	bool save = false;
+	double threshold = DefaultRegressionThreshold;
+
+	for (std::string_view arg : split_view(args, ' ', true))
+	{
+		if (ci_equals(arg, "dump"))
+			useDump = true;
+		else if (ci_equals(arg, "all"))
+			allPairs = true;
+		else if (ci_equals(arg, "save"))
+			save = true;
+		else if (double value = GetDoubleFromString(arg, 0); value > 0)
+			threshold = value;
+	}
+
+	// Either the live graph that /travelto uses, or one built from the dump with the current zone connections.
+	std::shared_ptr<const ZoneGraph> graph;
+	if (useDump)
+	{
+		std::string dumpFile = (std::filesystem::path(gPathResources) / "ZoneGuide.yaml").string();
+		graph = ZoneGraph::Build(ZoneGuideSnapshot::LoadDump(dumpFile));
+	}
+	else
+	{
+		graph = ZonePath_FinishGraphBuild();
+	}
+
+	if (!graph || graph->GetNodeCount() < 2)
+	{
+		SPDLOG_WARN("Zone graph is empty, nothing to benchmark.");
+		return;
+	}
+
+	int nodeCount = graph->GetNodeCount();
+	std::vector<std::pair<ZoneOrdinal, ZoneOrdinal>> queries;
+
+	if (allPairs)
+	{
+		queries.reserve((size_t)nodeCount * (nodeCount - 1));
+
+		for (int from = 0; from < nodeCount; ++from)
+		{
+			for (int to = 0; to < nodeCount; ++to)
+			{
+				if (from != to)
+					queries.emplace_back((ZoneOrdinal)from, (ZoneOrdinal)to);
+			}
+		}
+	}
+	else
+	{
+		// Use a fixed seed so that runs are comparable.
+		std::mt19937 rng(12345);
+		std::uniform_int_distribution<int> dist(0, nodeCount - 1);
+
+		queries.reserve(SampledQueryCount);
+		while ((int)queries.size() < SampledQueryCount)
+		{
+			ZoneOrdinal from = (ZoneOrdinal)dist(rng);
+			ZoneOrdinal to = (ZoneOrdinal)dist(rng);
+
+			if (from != to)
+				queries.emplace_back(from, to);
+		}
+	}
+
+	SPDLOG_INFO("Running \ay{}\ax zone path queries...", queries.size());
+
+	// The live graph goes through ZonePath_GeneratePath like /travelto does, starting from an empty
+	// cache. A graph from the dump isn't known to it, so that is searched directly.
+	ZonePathRoutingMode mode = g_configuration->GetRoutingMode();
+	ZoneEdgeMask edgeMask = graph->EvaluateRequirements();
+	std::vector<ZonePathNode> path;
+	std::string message;
+
+	ZonePath_ClearRouteCache();
+
+	std::vector<double> latencies;
+	latencies.reserve(queries.size());
+	int64_t nodesExpanded = 0;
+
+	for (const auto& [from, to] : queries)
+	{
+		int expanded = 0;
+		auto start = Clock::now();
+
+		if (useDump)
+			graph->FindPath(from, to, mode, edgeMask, path, &expanded);
+		else
+			ZonePath_GeneratePath(graph->GetNode(from).zoneId, graph->GetNode(to).zoneId, message, &expanded);
+
+		std::chrono::duration<double, std::micro> elapsed = Clock::now() - start;
+
+		latencies.push_back(elapsed.count());
+		nodesExpanded += expanded;
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+
+	ZonePathSuiteResults results;
+	results.source = fmt::format("{} {} {}", useDump ? "dump" : "live", allPairs ? "all" : "sampled",
+		ZonePathRoutingModeToString(mode));
+	results.queries = (int)queries.size();
+	results.p50 = latencies[latencies.size() / 2];
+	results.p99 = latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)];
+	results.nodesExpanded = (double)nodesExpanded / queries.size();
+
+	SPDLOG_INFO("\ay{}\ax zones, \ay{}\ax queries ({}): p50 \ay{:.2f}\ax us, p99 \ay{:.2f}\ax us, "
+		"\ay{:.1f}\ax zones expanded per query", nodeCount, results.queries,
+		results.source, results.p50, results.p99, results.nodesExpanded);
+
+	ZonePathSuiteResults baseline;
+	if (LoadBenchmarkBaseline(baseline))
+	{
+		if (baseline.source != results.source || baseline.queries != results.queries)
+		{
+			SPDLOG_WARN("Baseline was recorded with different queries ({}), not comparing", baseline.source);
+		}
+		else
+		{
+			auto check = [&](const char* name, double before, double after)
+			{
+				double change = before > 0 ? (after - before) * 100.0 / before : 0.0;
+				if (change > threshold)
+				{
+					SPDLOG_ERROR("\arFAILED\ax: {} regressed by \ar{:.1f}%\ax ({:.2f} -> {:.2f}), threshold is {:.1f}%",
+						name, change, before, after, threshold);
+					return false;
+				}
+
+				return true;
+			};
+
+			bool passed = check("p50 latency", baseline.p50, results.p50);
+			passed &= check("p99 latency", baseline.p99, results.p99);
+			passed &= check("zones expanded", baseline.nodesExpanded, results.nodesExpanded);
+
+			if (passed)
+				SPDLOG_INFO("\agPASSED\ax: no regression over {:.1f}% against the baseline", threshold);
+		}
+	}
+	else if (!save)
+	{
+		SPDLOG_INFO("No baseline to compare against, use \ay/travelto benchmark suite save\ax to record one");
+	}
+
+	if (save)
+	{
+		SaveBenchmarkBaseline(results);
+		SPDLOG_INFO("Saved benchmark baseline to {}", GetBenchmarkBaselineFile());
+	}
+}